@@ -16,9 +16,11 @@ static const uint8 kSpriteSizes[8][2] = {
 static void ppu_handlePixel(Ppu* ppu, int x, int y);
 static int ppu_getPixel(Ppu* ppu, int x, int y, bool sub, int* r, int* g, int* b);
 static int ppu_getPixelForBgLayer(Ppu *ppu, int x, int y, int layer, bool priority);
+static void ppu_beginRefLine(Ppu *ppu, int y);
 static void ppu_calculateMode7Starts(Ppu* ppu, int y);
 static int ppu_getPixelForMode7(Ppu* ppu, int x, int layer, bool priority);
 static bool ppu_getWindowState(Ppu* ppu, int layer, int x);
+static void ppu_binSprites(Ppu *ppu);
 static bool ppu_evaluateSprites(Ppu* ppu, int line);
 static void PpuDrawWholeLine(Ppu *ppu, uint y);
 
@@ -61,6 +63,7 @@ void ppu_reset(Ppu* ppu) {
   ppu->oamAdr = 0;
   ppu->oamSecondWrite = false;
   ppu->oamBuffer = 0;
+  ppu->spriteBinsValid = false;
   ppu->objTileAdr1 = 0x4000;
   ppu->objTileAdr2 = 0x5000;
   ppu->objSize = 0;
@@ -92,6 +95,7 @@ void ppu_reset(Ppu* ppu) {
   ppu->window1right = 0;
   ppu->window2left = 0;
   ppu->window2right = 0;
+  ppu->windowsValid = 0;
   ppu->clipMode = 0;
   ppu->preventMathMode = 0;
   ppu->addSubscreen = false;
@@ -145,9 +149,10 @@ void PpuBeginDrawing(Ppu *ppu, uint8_t *pixels, size_t pitch, uint32_t render_fl
   }
 
   if (PpuGetCurrentRenderScale(ppu, ppu->renderFlags) == 4) {
+    uint32 r_shift = (render_flags & kPpuRenderFlags_SwapRedBlue) ? 0 : 16, b_shift = 16 - r_shift;
     for (int i = 0; i < 256; i++) {
       uint32 color = ppu->cgram[i];
-      ppu->colorMapRgb[i] = ppu->brightnessMult[color & 0x1f] << 16 | ppu->brightnessMult[(color >> 5) & 0x1f] << 8 | ppu->brightnessMult[(color >> 10) & 0x1f];
+      ppu->colorMapRgb[i] = ppu->brightnessMult[color & 0x1f] << r_shift | ppu->brightnessMult[(color >> 5) & 0x1f] << 8 | ppu->brightnessMult[(color >> 10) & 0x1f] << b_shift;
     }
   }
 }
@@ -183,6 +188,7 @@ void ppu_runLine(Ppu *ppu, int line) {
     } else {
       if (ppu->mode == 7)
         ppu_calculateMode7Starts(ppu, line);
+      ppu_beginRefLine(ppu, line);
       for (int x = 0; x < 256; x++)
         ppu_handlePixel(ppu, x, line);
 
@@ -195,12 +201,6 @@ void ppu_runLine(Ppu *ppu, int line) {
   }
 }
 
-typedef struct PpuWindows {
-  int16 edges[6];
-  uint8 nr;
-  uint8 bits;
-} PpuWindows;
-
 static void PpuWindows_Clear(PpuWindows *win, Ppu *ppu, uint layer) {
   win->edges[0] = -(layer != 2 ? ppu->extraLeftCur : 0);
   win->edges[1] = 256 + (layer != 2 ? ppu->extraRightCur : 0);
@@ -208,7 +208,7 @@ static void PpuWindows_Clear(PpuWindows *win, Ppu *ppu, uint layer) {
   win->bits = 0;
 }
 
-static void PpuWindows_Calc(PpuWindows *win, Ppu *ppu, uint layer) {
+static void PpuWindows_Compute(PpuWindows *win, Ppu *ppu, uint layer) {
   // Evaluate which spans to render based on the window settings.
   // There are at most 5 windows.
   // Algorithm from Snes9x
@@ -269,6 +269,16 @@ static void PpuWindows_Calc(PpuWindows *win, Ppu *ppu, uint layer) {
   win->bits = w1_bits | w2_bits;
 }
 
+// The spans only change when a window register or the side space changes,
+// which for most scenes is once per frame rather than once per line.
+static void PpuWindows_Calc(PpuWindows *win, Ppu *ppu, uint layer) {
+  if (!(ppu->windowsValid & (1 << layer))) {
+    PpuWindows_Compute(&ppu->windows[layer], ppu, layer);
+    ppu->windowsValid |= 1 << layer;
+  }
+  *win = ppu->windows[layer];
+}
+
 // Draw a whole line of a 4bpp background layer into bgBuffers
 static void PpuDrawBackground_4bpp(Ppu *ppu, uint y, bool sub, uint layer, PpuZbufType zhi, PpuZbufType zlo) {
 #define DO_PIXEL(i) do { \
@@ -468,6 +478,14 @@ static void PpuDrawBackground_2bpp(Ppu *ppu, uint y, bool sub, uint layer, PpuZb
 #undef DO_PIXEL_HFLIP
 }
 
+// Width of the mosaic block that contains screen column sx, clipped to start at sx.
+// Blocks are aligned to column 0. This can't use the 8-bit mosaicModulo table
+// since the extra side space has columns below 0 and above 255.
+static int PpuMosaicFirstBlockWidth(Ppu *ppu, int sx) {
+  int size = ppu->mosaicSize, m = sx % size;
+  return size - (m < 0 ? m + size : m);
+}
+
 // Draw a whole line of a 4bpp background layer into bgBuffers, with mosaic applied
 static void PpuDrawBackground_4bpp_mosaic(Ppu *ppu, uint y, bool sub, uint layer, PpuZbufType zhi, PpuZbufType zlo) {
 #define GET_PIXEL() pixel = (bits) & 1 | (bits >> 7) & 2 | (bits >> 14) & 4 | (bits >> 21) & 8
@@ -500,7 +518,7 @@ static void PpuDrawBackground_4bpp_mosaic(Ppu *ppu, uint y, bool sub, uint layer
     const uint16 *tp = tps[x >> 8 & 1] + ((x >> 3) & 0x1f);
     const uint16 *tp_last = tps[x >> 8 & 1] + 31, *tp_next = tps[(x >> 8 & 1) ^ 1];
     x &= 7;
-    int w = ppu->mosaicSize - (sx - ppu->mosaicModulo[sx]);
+    int w = PpuMosaicFirstBlockWidth(ppu, sx);
     do {
       w = IntMin(w, dstz_end - dstz);
       uint32 tile = *tp;
@@ -559,7 +577,7 @@ static void PpuDrawBackground_2bpp_mosaic(Ppu *ppu, int y, bool sub, uint layer,
     const uint16 *tp = tps[x >> 8 & 1] + ((x >> 3) & 0x1f);
     const uint16 *tp_last = tps[x >> 8 & 1] + 31, *tp_next = tps[(x >> 8 & 1) ^ 1];
     x &= 7;
-    int w = ppu->mosaicSize - (sx - ppu->mosaicModulo[sx]);
+    int w = PpuMosaicFirstBlockWidth(ppu, sx);
     do {
       w = IntMin(w, dstz_end - dstz);
       uint32 tile = *tp;
@@ -654,7 +672,7 @@ static void PpuDrawBackground_mode7(Ppu *ppu, uint y, bool sub, PpuZbufType z) {
     uint32 outside_value = ppu->m7largeField ? 0x3ffff : 0xffffffff;
     bool char_fill = ppu->m7charFill;
     if (mosaic_enabled) {
-      int w = ppu->mosaicSize - (x - ppu->mosaicModulo[x]);
+      int w = PpuMosaicFirstBlockWidth(ppu, x);
       do {
         w = IntMin(w, dstz_end - dstz);
         if ((uint32)(xpos | ypos) > outside_value) {
@@ -695,6 +713,7 @@ void PpuSetMode7PerspectiveCorrection(Ppu *ppu, int low, int high) {
 void PpuSetExtraSideSpace(Ppu *ppu, int left, int right, int bottom) {
   ppu->extraLeftCur = UintMin(left, ppu->extraLeftRight);
   ppu->extraRightCur = UintMin(right, ppu->extraLeftRight);
+  ppu->windowsValid = 0;
   ppu->extraBottomCur = UintMin(bottom, 16);
 }
 
@@ -882,6 +901,7 @@ static NOINLINE void PpuDrawWholeLine(Ppu *ppu, uint y) {
                         ((cwin.bits & kCwBitsMod[ppu->preventMathMode]) ^ kCwBitsMod[ppu->preventMathMode + 4]) << 8;
 
   uint32 *dst = (uint32*)&ppu->renderBuffer[(y - 1) * ppu->renderPitch], *dst_org = dst;
+  uint32 r_shift = (ppu->renderFlags & kPpuRenderFlags_SwapRedBlue) ? 0 : 16, b_shift = 16 - r_shift;
   
   dst += (ppu->extraLeftRight - ppu->extraLeftCur);
 
@@ -897,9 +917,9 @@ static NOINLINE void PpuDrawWholeLine(Ppu *ppu, uint y) {
       uint32 i = left;
       do {
         uint32 color = ppu->cgram[ppu->bgBuffers[0].data[i] & 0xff];
-        dst[0] = ppu->brightnessMult[color & clip_color_mask] << 16 |
+        dst[0] = ppu->brightnessMult[color & clip_color_mask] << r_shift |
                  ppu->brightnessMult[(color >> 5) & clip_color_mask] << 8 |
-                 ppu->brightnessMult[(color >> 10) & clip_color_mask];
+                 ppu->brightnessMult[(color >> 10) & clip_color_mask] << b_shift;
       } while (dst++, ++i < right);
     } else {
       uint8 *half_color_map = ppu->halfColor ? ppu->brightnessMultHalf : ppu->brightnessMult;
@@ -934,7 +954,7 @@ static NOINLINE void PpuDrawWholeLine(Ppu *ppu, uint y) {
             b += b2;
           }
         }
-        dst[0] = color_map[b] | color_map[g] << 8 | color_map[r] << 16;
+        dst[0] = color_map[b] << b_shift | color_map[g] << 8 | color_map[r] << r_shift;
       } while (dst++, ++i < right);
     }
   } while (cw_clip_math >>= 1, ++windex < cwin.nr);
@@ -954,7 +974,7 @@ static void ppu_handlePixel(Ppu* ppu, int x, int y) {
   if (!ppu->forcedBlank) {
     int mainLayer = ppu_getPixel(ppu, x, y, false, &r, &g, &b);
 
-    bool colorWindowState = ppu_getWindowState(ppu, 5, x);
+    bool colorWindowState = ppu->refColorWindow[x];
     if (
       ppu->clipMode == 3 ||
       (ppu->clipMode == 2 && colorWindowState) ||
@@ -1001,9 +1021,10 @@ static void ppu_handlePixel(Ppu* ppu, int x, int y) {
   }
   int row = y - 1;
   uint8 *pixelBuffer = (uint8*) &ppu->renderBuffer[row * ppu->renderPitch + (x + ppu->extraLeftRight) * 4];
-  pixelBuffer[0] = ((b << 3) | (b >> 2)) * ppu->brightness / 15;
+  int b_index = (ppu->renderFlags & kPpuRenderFlags_SwapRedBlue) ? 2 : 0;
+  pixelBuffer[b_index] = ((b << 3) | (b >> 2)) * ppu->brightness / 15;
   pixelBuffer[1] = ((g << 3) | (g >> 2)) * ppu->brightness / 15;
-  pixelBuffer[2] = ((r << 3) | (r >> 2)) * ppu->brightness / 15;
+  pixelBuffer[2 - b_index] = ((r << 3) | (r >> 2)) * ppu->brightness / 15;
   pixelBuffer[3] = 0;
 }
 
@@ -1058,39 +1079,24 @@ static int ppu_getPixel(Ppu *ppu, int x, int y, bool sub, int *r, int *g, int *b
   
   // figure out which color is on this location on main- or subscreen, sets it in r, g, b
   // returns which layer it is: 0-3 for bg layer, 4 or 6 for sprites (depending on palette), 5 for backdrop
-  int actMode = ppu->mode == 1 ? 8 : ppu->mode;
-  actMode = ppu->mode == 7 && ppu->m7extBg_always_zero ? 9 : actMode;
+  int actMode = ppu->refActMode;
   int layer = 5;
   int pixel = 0;
   for (int i = 0; i < layerCountPerMode[actMode]; i++) {
     int curLayer = layersPerMode[actMode][i];
     int curPriority = prioritysPerMode[actMode][i];
-    bool layerActive = false;
-    if (!sub) {
-      layerActive = IS_SCREEN_ENABLED(ppu, 0, curLayer) && (
-        !IS_SCREEN_WINDOWED(ppu, 0, curLayer) || !ppu_getWindowState(ppu, curLayer, x)
-        );
-    } else {
-      layerActive = IS_SCREEN_ENABLED(ppu, 1, curLayer) && (
-        !IS_SCREEN_WINDOWED(ppu, 1, curLayer) || !ppu_getWindowState(ppu, curLayer, x)
-        );
-    }
-    if (layerActive) {
+    if (ppu->refLayerActive[sub][x] & (1 << curLayer)) {
       if (curLayer < 4) {
         // bg layer
         int lx = x;
-        int ly = y;
-        if (IS_MOSAIC_ENABLED(ppu, curLayer)) {
+        if (IS_MOSAIC_ENABLED(ppu, curLayer))
           lx -= lx % ppu->mosaicSize;
-          ly -= (ly - 1) % ppu->mosaicSize;
-        }
         if (ppu->mode == 7) {
           pixel = ppu_getPixelForMode7(ppu, lx, curLayer, curPriority);
         } else {
           lx += ppu->bgLayer[curLayer].hScroll;
-          ly += ppu->bgLayer[curLayer].vScroll;
           pixel = ppu_getPixelForBgLayer(
-            ppu, lx & 0x3ff, ly & 0x3ff,
+            ppu, lx & 0x3ff, ppu->refLayerY[curLayer],
             curLayer, curPriority
           );
         }
@@ -1116,7 +1122,49 @@ static int ppu_getPixel(Ppu *ppu, int x, int y, bool sub, int *r, int *g, int *b
 }
 
 
-static int ppu_getPixelForBgLayer(Ppu *ppu, int x, int y, int layer, bool priority) {
+// Registers and vram don't change while a line is drawn, so the per-pixel renderer
+// computes the line's mode, layer rows and window masks once, and decodes each
+// tile row only once.
+static void ppu_beginRefLine(Ppu *ppu, int y) {
+  int actMode = ppu->mode == 1 ? 8 : ppu->mode;
+  ppu->refActMode = ppu->mode == 7 && ppu->m7extBg_always_zero ? 9 : actMode;
+  for (int i = 0; i < 4; i++) {
+    int ly = y;
+    if (IS_MOSAIC_ENABLED(ppu, i))
+      ly -= (ly - 1) % ppu->mosaicSize;
+    ppu->refLayerY[i] = (ly + ppu->bgLayer[i].vScroll) & 0x3ff;
+    ppu->refTileRows[i].key = -1;
+  }
+  // Only windows that are enabled and used, by TMW/TSW for the layers or by
+  // CGWSEL for the color window, need evaluating per column
+  uint8_t used = (ppu->screenWindowed[0] | ppu->screenWindowed[1]) & 0x3f;
+  if (ppu->clipMode == 1 || ppu->clipMode == 2 || ppu->preventMathMode == 1 || ppu->preventMathMode == 2)
+    used |= 1 << 5;
+  for (int i = 0; i < 6; i++) {
+    if (!(GET_WINDOW_FLAGS(ppu, i) & (kWindow1Enabled | kWindow2Enabled)))
+      used &= ~(1 << i);
+  }
+  if (!used) {
+    memset(ppu->refLayerActive[0], ppu->screenEnabled[0] & 0x3f, 256);
+    memset(ppu->refLayerActive[1], ppu->screenEnabled[1] & 0x3f, 256);
+    memset(ppu->refColorWindow, 0, 256);
+    return;
+  }
+  for (int x = 0; x < 256; x++) {
+    // bit per layer, set where the layer's window applies
+    uint8_t windowed = 0;
+    for (int i = 0; i < 6; i++) {
+      if (used & (1 << i))
+        windowed |= ppu_getWindowState(ppu, i, x) << i;
+    }
+    ppu->refLayerActive[0][x] = ppu->screenEnabled[0] & ~(ppu->screenWindowed[0] & windowed) & 0x3f;
+    ppu->refLayerActive[1][x] = ppu->screenEnabled[1] & ~(ppu->screenWindowed[1] & windowed) & 0x3f;
+    ppu->refColorWindow[x] = windowed >> 5 & 1;
+  }
+}
+
+// Decodes the 8 pixels of the tile row starting at x
+static void ppu_fetchTileRow(Ppu *ppu, PpuRefTileRow *dst, int x, int y, int layer) {
   BgLayer *layerp = &ppu->bgLayer[layer];
   // figure out address of tilemap word and read it
   bool wideTiles = ppu->mode == 5 || ppu->mode == 6;
@@ -1128,12 +1176,10 @@ static int ppu_getPixelForBgLayer(Ppu *ppu, int x, int y, int layer, bool priori
   if ((x & tileHighBitX) && layerp->tilemapWider) tilemapAdr += 0x400;
   if ((y & tileHighBitY) && layerp->tilemapHigher) tilemapAdr += layerp->tilemapWider ? 0x800 : 0x400;
   uint16_t tile = ppu->vram[tilemapAdr & 0x7fff];
-  // check priority, get palette
-  if (((bool)(tile & 0x2000)) != priority) return 0; // wrong priority
+  dst->tile = tile;
   int paletteNum = (tile & 0x1c00) >> 10;
-  // figure out position within tile
+  // figure out row within tile
   int row = (tile & 0x8000) ? 7 - (y & 0x7) : (y & 0x7);
-  int col = (tile & 0x4000) ? (x & 0x7) : 7 - (x & 0x7);
   int tileNum = tile & 0x3ff;
   if (wideTiles) {
     // if unflipped right half of tile, or flipped left half of tile
@@ -1142,30 +1188,38 @@ static int ppu_getPixelForBgLayer(Ppu *ppu, int x, int y, int layer, bool priori
   // read tiledata, ajust palette for mode 0
   int bitDepth = bitDepthsPerMode[ppu->mode][layer];
   if (ppu->mode == 0) paletteNum += 8 * layer;
-  // plane 1 (always)
-  int paletteSize = 4;
-  uint16_t plane1 = ppu->vram[(layerp->tileAdr + ((tileNum & 0x3ff) * 4 * bitDepth) + row) & 0x7fff];
-  int pixel = (plane1 >> col) & 1;
-  pixel |= ((plane1 >> (8 + col)) & 1) << 1;
-  // plane 2 (for 4bpp, 8bpp)
-  if (bitDepth > 2) {
-    paletteSize = 16;
-    uint16_t plane2 = ppu->vram[(layerp->tileAdr + ((tileNum & 0x3ff) * 4 * bitDepth) + 8 + row) & 0x7fff];
+  int paletteSize = bitDepth > 4 ? 256 : bitDepth > 2 ? 16 : 4;
+  int tileAdr = layerp->tileAdr + ((tileNum & 0x3ff) * 4 * bitDepth) + row;
+  // plane 1 (always), plane 2 (for 4bpp, 8bpp), plane 3 & 4 (for 8bpp)
+  uint16_t plane1 = ppu->vram[tileAdr & 0x7fff];
+  uint16_t plane2 = bitDepth > 2 ? ppu->vram[(tileAdr + 8) & 0x7fff] : 0;
+  uint16_t plane3 = bitDepth > 4 ? ppu->vram[(tileAdr + 16) & 0x7fff] : 0;
+  uint16_t plane4 = bitDepth > 4 ? ppu->vram[(tileAdr + 24) & 0x7fff] : 0;
+  for (int i = 0; i < 8; i++) {
+    int col = (tile & 0x4000) ? i : 7 - i;
+    int pixel = (plane1 >> col) & 1;
+    pixel |= ((plane1 >> (8 + col)) & 1) << 1;
     pixel |= ((plane2 >> col) & 1) << 2;
     pixel |= ((plane2 >> (8 + col)) & 1) << 3;
-  }
-  // plane 3 & 4 (for 8bpp)
-  if (bitDepth > 4) {
-    paletteSize = 256;
-    uint16_t plane3 = ppu->vram[(layerp->tileAdr + ((tileNum & 0x3ff) * 4 * bitDepth) + 16 + row) & 0x7fff];
     pixel |= ((plane3 >> col) & 1) << 4;
     pixel |= ((plane3 >> (8 + col)) & 1) << 5;
-    uint16_t plane4 = ppu->vram[(layerp->tileAdr + ((tileNum & 0x3ff) * 4 * bitDepth) + 24 + row) & 0x7fff];
     pixel |= ((plane4 >> col) & 1) << 6;
     pixel |= ((plane4 >> (8 + col)) & 1) << 7;
+    // cgram index, or 0 if transparent, palette number in bits 10-8 for 8-color layers
+    dst->pixels[i] = pixel == 0 ? 0 : paletteSize * paletteNum + pixel;
   }
-  // return cgram index, or 0 if transparent, palette number in bits 10-8 for 8-color layers
-  return pixel == 0 ? 0 : paletteSize * paletteNum + pixel;
+}
+
+static int ppu_getPixelForBgLayer(Ppu *ppu, int x, int y, int layer, bool priority) {
+  PpuRefTileRow *row = &ppu->refTileRows[layer];
+  int key = y << 7 | x >> 3;
+  if (row->key != key) {
+    row->key = key;
+    ppu_fetchTileRow(ppu, row, x & ~7, y, layer);
+  }
+  // check priority
+  if (((bool)(row->tile & 0x2000)) != priority) return 0; // wrong priority
+  return row->pixels[x & 7];
 }
 
 static void ppu_calculateMode7Starts(Ppu* ppu, int y) {
@@ -1236,11 +1290,28 @@ static bool ppu_getWindowState(Ppu* ppu, int layer, int x) {
   return test1 || test2;
 }
 
+// Sorts the sprites into per-line lists in oam order, so each line only
+// visits the sprites that are in y-range of it.
+static void ppu_binSprites(Ppu *ppu) {
+  memset(ppu->spriteBinCount, 0, sizeof(ppu->spriteBinCount));
+  for (int i = 0; i < 128; i++) {
+    int yy = ppu->oam[i * 2] >> 8;
+    if (yy == 0xf0)
+      continue;  // this works for zelda because sprites are always 8 or 16.
+    int highOam = ppu->oam[0x100 + (i >> 3)] >> (i * 2 & 15);
+    int spriteSize = kSpriteSizes[ppu->objSize][(highOam >> 1) & 1];
+    for (int row = 0; row < spriteSize; row++) {
+      int line = (yy + row) & 0xff;
+      ppu->spriteBins[line][ppu->spriteBinCount[line]++] = i;
+    }
+  }
+  ppu->spriteBinsValid = true;
+}
+
 static bool ppu_evaluateSprites(Ppu* ppu, int line) {
   // TODO: iterate over oam normally to determine in-range sprites,
   //   then iterate those in-range sprites in reverse for tile-fetching
   // TODO: rectangular sprites, wierdness with sprites at -256
-  int index = 0, index_end = index;
   int spritesLeft = 32 + 1, tilesLeft = 34 + 1;
   uint8 spriteSizes[2] = { kSpriteSizes[ppu->objSize][0], kSpriteSizes[ppu->objSize][1] };
   int extra_left_right = ppu->extraLeftRight;
@@ -1248,16 +1319,16 @@ static bool ppu_evaluateSprites(Ppu* ppu, int line) {
     spritesLeft = tilesLeft = 1024;
   int tilesLeftOrg = tilesLeft;
 
-  do {
+  if (!ppu->spriteBinsValid)
+    ppu_binSprites(ppu);
+  const uint8 *bin = ppu->spriteBins[line & 0xff];
+  for (int i = 0, n = ppu->spriteBinCount[line & 0xff]; i < n; i++) {
+    int index = bin[i] * 2;
     int yy = ppu->oam[index] >> 8;
-    if (yy == 0xf0)
-      continue;  // this works for zelda because sprites are always 8 or 16.
-    // check if the sprite is on this line and get the sprite size
+    // the sprite is on this line, get the row and the sprite size
     int row = (line - yy) & 0xff;
     int highOam = ppu->oam[0x100 + (index >> 4)] >> (index & 15);
     int spriteSize = spriteSizes[(highOam >> 1) & 1];
-    if (row >= spriteSize)
-      continue;
     // in y-range, get the x location, using the high bit as well
     int x = (ppu->oam[index] & 0xff) + (highOam & 1) * 256;
     x -= (x >= 256 + extra_left_right) * 512;
@@ -1304,7 +1375,7 @@ static bool ppu_evaluateSprites(Ppu* ppu, int line) {
         }
       }
     }
-  } while ((index = (index + 2) & 0xff) != index_end);
+  }
   return (tilesLeft != tilesLeftOrg);
 }
 
@@ -1348,6 +1419,7 @@ void ppu_write(Ppu* ppu, uint8_t adr, uint8_t val) {
       } else {
         if (ppu->oamAdr < 0x110)
           ppu->oam[ppu->oamAdr++] = (val << 8) | ppu->oamBuffer;
+        ppu->spriteBinsValid = false;
       }
       ppu->oamSecondWrite = !ppu->oamSecondWrite;
       break;
@@ -1477,26 +1549,41 @@ void ppu_write(Ppu* ppu, uint8_t adr, uint8_t val) {
       ppu->cgramSecondWrite = !ppu->cgramSecondWrite;
       break;
     }
-    case 0x23:  // W12SEL
-      ppu->windowsel = (ppu->windowsel & ~0xff) | val;
+    // The spotlight and other window effects rewrite these from hdma on every
+    // line, mostly with unchanged values, so keep the spans unless one changes.
+    case 0x23: {  // W12SEL
+      uint32 windowsel = (ppu->windowsel & ~0xff) | val;
+      if (ppu->windowsel != windowsel)
+        ppu->windowsel = windowsel, ppu->windowsValid = 0;
       break;
-    case 0x24:  // W34SEL
-      ppu->windowsel = (ppu->windowsel & ~0xff00) | (val << 8);
+    }
+    case 0x24: {  // W34SEL
+      uint32 windowsel = (ppu->windowsel & ~0xff00) | (val << 8);
+      if (ppu->windowsel != windowsel)
+        ppu->windowsel = windowsel, ppu->windowsValid = 0;
       break;
-    case 0x25:  // WOBJSEL
-      ppu->windowsel = (ppu->windowsel & ~0xff0000) | (val << 16);
+    }
+    case 0x25: {  // WOBJSEL
+      uint32 windowsel = (ppu->windowsel & ~0xff0000) | (val << 16);
+      if (ppu->windowsel != windowsel)
+        ppu->windowsel = windowsel, ppu->windowsValid = 0;
       break;
+    }
     case 0x26:
-      ppu->window1left = val;
+      if (ppu->window1left != val)
+        ppu->window1left = val, ppu->windowsValid = 0;
       break;
     case 0x27:
-      ppu->window1right = val;
+      if (ppu->window1right != val)
+        ppu->window1right = val, ppu->windowsValid = 0;
       break;
     case 0x28:
-      ppu->window2left = val;
+      if (ppu->window2left != val)
+        ppu->window2left = val, ppu->windowsValid = 0;
       break;
     case 0x29:
-      ppu->window2right = val;
+      if (ppu->window2right != val)
+        ppu->window2right = val, ppu->windowsValid = 0;
       break;
     case 0x2a:  // WBGLOG
       assert(val == 0);
@@ -34,6 +34,19 @@ typedef struct PpuPixelPrioBufs {
   PpuZbufType data[kPpuXPixels];
 } PpuPixelPrioBufs;
 
+typedef struct PpuWindows {
+  int16 edges[6];
+  uint8 nr;
+  uint8 bits;
+} PpuWindows;
+
+// A decoded tile row, cached by the per-pixel renderer for the line being drawn
+typedef struct PpuRefTileRow {
+  int32_t key;  // y << 7 | x >> 3 of the cached row, -1 if none
+  uint16_t tile;
+  uint16_t pixels[8];
+} PpuRefTileRow;
+
 enum {
   kPpuRenderFlags_NewRenderer = 1,
   // Render mode7 upsampled by 4x4
@@ -42,6 +55,8 @@ enum {
   kPpuRenderFlags_Height240 = 4,
   // Disable sprite render limits
   kPpuRenderFlags_NoSpriteLimits = 8,
+  // Output xBGR pixels instead of xRGB, for textures that are natively in that order
+  kPpuRenderFlags_SwapRedBlue = 16,
 };
 
 
@@ -70,6 +85,9 @@ struct Ppu {
   uint8_t window2left;
   uint8_t window2right;
   uint32_t windowsel;
+  // window spans per layer, valid while the window registers are unchanged
+  uint8_t windowsValid;
+  PpuWindows windows[6];
 
   // color math
   uint8_t clipMode;
@@ -113,8 +131,19 @@ struct Ppu {
   // mode 7 internal
   int32_t m7startX;
   int32_t m7startY;
+  // per-line state of the per-pixel renderer
+  uint8_t refActMode;
+  uint16_t refLayerY[4];
+  uint8_t refLayerActive[2][256];  // bit per layer, main and sub screen
+  uint8_t refColorWindow[256];
+  PpuRefTileRow refTileRows[4];
 
   uint16_t oam[0x110];
+  // sprite indexes binned by the lines they cover, rebuilt when oam changes.
+  // Code that copies into oam directly must clear spriteBinsValid.
+  bool spriteBinsValid;
+  uint8_t spriteBinCount[256];
+  uint8_t spriteBins[256][128];
   
   // store 31 extra entries to remove the need for clamp
   uint8_t brightnessMult[32 + 31];
@@ -6800,6 +6800,10 @@ int Ancilla_AddAncilla(uint8 a, uint8 y) {  // 899ce2
   return k;
 }
 
+// Slot lookups scan ancilla_type from the top and stop at the first match.
+// ancilla_type is written directly in about 130 places and changes mid-frame
+// as ancillae spawn, so a per-type slot mask would have to be rebuilt on every
+// query, which is no cheaper than the scan.
 bool AncillaAdd_CheckForPresence(uint8 a) {  // 899d20
   for (int k = 5; k >= 0; k--) {
     if (ancilla_type[k] == a)
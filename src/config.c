@@ -425,6 +425,12 @@ static bool HandleGraphicsConfig(const char *key, char *value) {
                              StringEqualsNoCase(value, "Vulkan") ? kOutputMethod_Vulkan :
                                                                    kOutputMethod_SDL;
     return true;
+  } else if (StringEqualsNoCase(key, "PresentMode")) {
+    g_config.present_mode = StringEqualsNoCase(value, "FIFO-Relaxed") ? kPresentMode_FifoRelaxed :
+                            StringEqualsNoCase(value, "Mailbox") ? kPresentMode_Mailbox :
+                            StringEqualsNoCase(value, "Immediate") ? kPresentMode_Immediate :
+                                                                     kPresentMode_Fifo;
+    return true;
   } else if (StringEqualsNoCase(key, "LinearFiltering")) {
     return ParseBool(value, &g_config.linear_filtering);
   } else if (StringEqualsNoCase(key, "NoSpriteLimits")) {
@@ -511,6 +517,9 @@ static bool HandleGeneralConfig(const char *key, char *value) {
     return ParseBool(value, &g_config.display_perf_title);
   } else if (StringEqualsNoCase(key, "DisableFrameDelay")) {
     return ParseBool(value, &g_config.disable_frame_delay);
+  } else if (StringEqualsNoCase(key, "LogFramePacing")) {
+    g_config.log_frame_pacing = (uint16)strtol(value, (char**)NULL, 10);
+    return true;
   } else if (StringEqualsNoCase(key, "Language")) {
     g_config.language = value;
     return true;
@@ -45,6 +45,13 @@ enum {
   kOutputMethod_Vulkan,
 };
 
+enum {
+  kPresentMode_Fifo,
+  kPresentMode_FifoRelaxed,
+  kPresentMode_Mailbox,
+  kPresentMode_Immediate,
+};
+
 typedef struct Config {
   int window_width;
   int window_height;
@@ -56,6 +63,7 @@ typedef struct Config {
   bool enable_audio;
   bool linear_filtering;
   uint8 output_method;
+  uint8 present_mode;
   uint16 audio_freq;
   uint8 audio_channels;
   uint16 audio_samples;
@@ -67,6 +75,7 @@ typedef struct Config {
   uint8 enable_msu;
   bool resume_msu;
   bool disable_frame_delay;
+  uint16 log_frame_pacing;
   uint8 msuvolume;
   uint32 features0;
 
@@ -35,6 +35,11 @@ const char* kDefaultConfigIni =
     "# (default: 0, accepts: 0/1)\n"
     "DisableFrameDelay = 0\n"
     "\n"
+    "# Log frame pacing statistics (mean, jitter, worst frame time) every N seconds\n"
+    "# 0 only logs them once on exit. Not used with DisableFrameDelay.\n"
+    "# (default: 0, accepts: seconds)\n"
+    "LogFramePacing = 0\n"
+    "\n"
     "# ------------------------------------------------------------------------------\n"
     "# Display Configuration\n"
     "# ------------------------------------------------------------------------------\n"
@@ -109,6 +114,15 @@ const char* kDefaultConfigIni =
     "#   Vulkan       = Vulkan 1.0 (cross-platform, requires Vulkan SDK or MoltenVK on macOS)\n"
     "OutputMethod = SDL\n"
     "\n"
+    "# Vulkan presentation mode\n"
+    "# (default: FIFO, accepts: FIFO, FIFO-Relaxed, Mailbox, Immediate)\n"
+    "#   FIFO         = Wait for vsync (always supported)\n"
+    "#   FIFO-Relaxed = Wait for vsync, but tear instead of stalling when a frame is late\n"
+    "#   Mailbox      = Lowest latency without tearing, newest frame replaces queued one\n"
+    "#   Immediate    = No vsync, may tear\n"
+    "# Falls back to FIFO if the driver does not support the requested mode.\n"
+    "PresentMode = FIFO\n"
+    "\n"
     "# Use linear filtering for smoother pixels\n"
     "# (default: 0, accepts: 0/1)\n"
     "# Disable for crisp, pixelated look. Works with SDL and OpenGL.\n"
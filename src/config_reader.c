@@ -50,6 +50,13 @@ static int parse_aspect_ratio(const char *value) {
     return 0;  // default to original
 }
 
+static int parse_present_mode(const char *value) {
+    if (strcmp(value, "FIFO-Relaxed") == 0) return kPresentMode_FifoRelaxed;
+    if (strcmp(value, "Mailbox") == 0) return kPresentMode_Mailbox;
+    if (strcmp(value, "Immediate") == 0) return kPresentMode_Immediate;
+    return kPresentMode_Fifo;
+}
+
 static int parse_output_method(const char *value) {
     if (strcmp(value, "SDL") == 0) return 0;
     if (strcmp(value, "OpenGL") == 0) return 1;
@@ -119,6 +126,7 @@ bool ConfigReader_Read(const char *path, Config *config) {
             if (strcmp(key, "Autosave") == 0) config->autosave = parse_bool(value);
             else if (strcmp(key, "DisplayPerfInTitle") == 0) config->display_perf_title = parse_bool(value);
             else if (strcmp(key, "DisableFrameDelay") == 0) config->disable_frame_delay = parse_bool(value);
+            else if (strcmp(key, "LogFramePacing") == 0) config->log_frame_pacing = parse_int(value);
             else if (strcmp(key, "ExtendedAspectRatio") == 0) config->extended_aspect_ratio = parse_aspect_ratio(value);
             else if (strcmp(key, "Language") == 0) config->language = parse_string(value);
         }
@@ -150,6 +158,7 @@ bool ConfigReader_Read(const char *path, Config *config) {
             else if (strcmp(key, "Fullscreen") == 0) config->fullscreen = parse_bool(value);
             else if (strcmp(key, "IgnoreAspectRatio") == 0) config->ignore_aspect_ratio = parse_bool(value);
             else if (strcmp(key, "OutputMethod") == 0) config->output_method = parse_output_method(value);
+            else if (strcmp(key, "PresentMode") == 0) config->present_mode = parse_present_mode(value);
             else if (strcmp(key, "LinearFiltering") == 0) config->linear_filtering = parse_bool(value);
             else if (strcmp(key, "NewRenderer") == 0) config->new_renderer = parse_bool(value);
             else if (strcmp(key, "EnhancedMode7") == 0) config->enhanced_mode7 = parse_bool(value);
@@ -15,6 +15,7 @@ void ConfigWriter_InitDefaults(Config *config) {
   config->autosave = false;
   config->display_perf_title = false;
   config->disable_frame_delay = false;
+  config->log_frame_pacing = 0;
 
   // Graphics defaults  config->window_width = 0;  // Auto
   config->window_height = 0;  // Auto
@@ -22,6 +23,7 @@ void ConfigWriter_InitDefaults(Config *config) {
   config->fullscreen = 0;  // Windowed
   config->ignore_aspect_ratio = false;
   config->output_method = kOutputMethod_SDL;
+  config->present_mode = kPresentMode_Fifo;
   config->linear_filtering = false;
   config->new_renderer = true;
   config->enhanced_mode7 = true;
@@ -84,6 +86,11 @@ static bool WriteGeneralSection(FILE *f, const Config *config) {
   if (!WriteLine(f, "# (default: 0, accepts: 0/1)\n")) return false;
   if (!WriteLine(f, "DisableFrameDelay = %d\n\n", config->disable_frame_delay ? 1 : 0)) return false;
 
+  if (!WriteLine(f, "# Log frame pacing statistics (mean, jitter, worst frame time) every N seconds\n")) return false;
+  if (!WriteLine(f, "# 0 only logs them once on exit. Not used with DisableFrameDelay.\n")) return false;
+  if (!WriteLine(f, "# (default: 0, accepts: seconds)\n")) return false;
+  if (!WriteLine(f, "LogFramePacing = %d\n\n", config->log_frame_pacing)) return false;
+
   if (!WriteLine(f, "# ------------------------------------------------------------------------------\n")) return false;
   if (!WriteLine(f, "# Display Configuration\n")) return false;
   if (!WriteLine(f, "# ------------------------------------------------------------------------------\n\n")) return false;
@@ -197,6 +204,22 @@ static bool WriteGraphicsSection(FILE *f, const Config *config) {
   }
   if (!WriteLine(f, "OutputMethod = %s\n\n", output_method_str)) return false;
 
+  if (!WriteLine(f, "# Vulkan presentation mode\n")) return false;
+  if (!WriteLine(f, "# (default: FIFO, accepts: FIFO, FIFO-Relaxed, Mailbox, Immediate)\n")) return false;
+  if (!WriteLine(f, "#   FIFO         = Wait for vsync (always supported)\n")) return false;
+  if (!WriteLine(f, "#   FIFO-Relaxed = Wait for vsync, but tear instead of stalling when a frame is late\n")) return false;
+  if (!WriteLine(f, "#   Mailbox      = Lowest latency without tearing, newest frame replaces queued one\n")) return false;
+  if (!WriteLine(f, "#   Immediate    = No vsync, may tear\n")) return false;
+  if (!WriteLine(f, "# Falls back to FIFO if the driver does not support the requested mode.\n")) return false;
+  const char *present_mode_str = "FIFO";
+  switch (config->present_mode) {
+    case kPresentMode_Fifo: present_mode_str = "FIFO"; break;
+    case kPresentMode_FifoRelaxed: present_mode_str = "FIFO-Relaxed"; break;
+    case kPresentMode_Mailbox: present_mode_str = "Mailbox"; break;
+    case kPresentMode_Immediate: present_mode_str = "Immediate"; break;
+  }
+  if (!WriteLine(f, "PresentMode = %s\n\n", present_mode_str)) return false;
+
   if (!WriteLine(f, "# Use linear filtering for smoother pixels\n")) return false;
   if (!WriteLine(f, "# (default: 0, accepts: 0/1)\n")) return false;
   if (!WriteLine(f, "# Disable for crisp, pixelated look. Works with SDL and OpenGL.\n")) return false;
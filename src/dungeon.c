@@ -3826,6 +3826,9 @@ void Dungeon_LoadAttribute_Selectable() {  // 81b8b4
   }
 }
 
+// The basic pass is rebuilt on every room load. Its input is the tilemap that
+// was just drawn, so a per-room cache is only safe with a full compare of that
+// tilemap, which costs about as much as the rebuild.
 void Dungeon_LoadAttributeTable() {  // 81b8bf
   dung_draw_width_indicator = dung_draw_height_indicator = 0;
   Dungeon_LoadBasicAttribute_full(0x1000);
@@ -8,6 +8,7 @@
 #include <stdio.h>
 #include <assert.h>
 #include <string.h>
+#include <math.h>
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_NO_THREAD_LOCALS
 #define STBI_ONLY_PNG
@@ -307,6 +308,8 @@ static bool GlslPass_Compile(GlslPass *p, uint type, const uint8 *data, size_t s
 
 static void GlslTextureUniform_Read(uint program, const char *prefix, int i, GlslTextureUniform *result) {
   char buf[40];
+  result->cur_unit = -1;
+  result->cur_size[0] = result->cur_size[1] = -1.0f;
   char *e = &buf[snprintf(buf, sizeof(buf), i >= 0 ? "%s%u" : "%s", prefix, i)];
   memcpy(e, "Texture", 8);
   result->Texture = glGetUniformLocation(program, buf);
@@ -340,6 +343,9 @@ static void GlslShader_GetUniforms(GlslShader *gs) {
     p->unif.OutputSize = glGetUniformLocation(program, "OutputSize");
     p->unif.FrameCount = glGetUniformLocation(program, "FrameCount");
     p->unif.FrameDirection = glGetUniformLocation(program, "FrameDirection");
+    p->unif.cur_output_size[0] = p->unif.cur_output_size[1] = -1.0f;
+    p->unif.cur_frame_count = -1;
+    p->unif.frame_direction_set = false;
     p->unif.LUTTexCoord = glGetAttribLocation(program, "LUTTexCoord");
     p->unif.VertexCoord = glGetAttribLocation(program, "VertexCoord");
     GlslTextureUniform_Read(program, "Orig", -1, &p->unif.Orig);
@@ -353,10 +359,14 @@ static void GlslShader_GetUniforms(GlslShader *gs) {
       GlslTextureUniform_Read(program, "PassPrev", j, &p->unif.PassPrev[j]);
     }
     GlslTexture *t = gs->first_texture;
-    for (int j = 0; t != NULL; t = t->next, j++)
+    for (int j = 0; t != NULL; t = t->next, j++) {
       p->unif.Texture[j] = glGetUniformLocation(program, t->id);
-    for (GlslParam *pa = gs->first_param; pa != NULL; pa = pa->next)
+      p->unif.TextureUnit[j] = -1;
+    }
+    for (GlslParam *pa = gs->first_param; pa != NULL; pa = pa->next) {
       pa->uniform[pass_idx] = glGetUniformLocation(program, pa->id);
+      pa->cur_value[pass_idx] = NAN;
+    }
   }
   glUseProgram(0);
 }
@@ -393,11 +403,110 @@ static void GlslShader_LoadTextures(GlslShader *gs, const char *base_filename) {
   }
 }
 
+// Linked programs are cached in saves/ as driver specific binaries. The key
+// covers the preprocessed source, the GLES/desktop mode and the driver
+// strings, so a driver update or an edited shader just misses the cache.
+enum {
+  kGlslCacheMagic = 0x42504c47,  // 'GLPB'
+  kGlslCacheVersion = 1,
+};
+
+typedef struct GlslCacheHeader {
+  uint32 magic;
+  uint32 version;
+  uint64 key;
+  uint32 binary_format;
+  uint32 length;
+} GlslCacheHeader;
+
+static uint64 Fnv1a64(uint64 h, const void *data, size_t size) {
+  const uint8 *d = (const uint8 *)data;
+  for (size_t i = 0; i < size; i++)
+    h = (h ^ d[i]) * 0x100000001b3ull;
+  return h;
+}
+
+static bool GlslShaderCache_IsSupported() {
+  GLint num_formats = 0;
+  if (!glGetProgramBinary || !glProgramBinary || !glProgramParameteri)
+    return false;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+  return num_formats > 0;
+}
+
+static uint64 GlslShaderCache_Key(const uint8 *data, size_t size, bool opengl_es) {
+  static const GLenum kDriverStrings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+  uint32 version = kGlslCacheVersion;
+  uint64 h = Fnv1a64(0xcbf29ce484222325ull, &version, sizeof(version));
+  h = Fnv1a64(h, &opengl_es, sizeof(opengl_es));
+  for (int i = 0; i < countof(kDriverStrings); i++) {
+    const char *s = (const char *)glGetString(kDriverStrings[i]);
+    if (s)
+      h = Fnv1a64(h, s, strlen(s) + 1);
+  }
+  return Fnv1a64(h, data, size);
+}
+
+static void GlslShaderCache_Filename(char *buf, size_t bufsize, uint64 key) {
+  snprintf(buf, bufsize, "saves/shader_%08x%08x.bin", (uint32)(key >> 32), (uint32)key);
+}
+
+static bool GlslShaderCache_Load(uint program, uint64 key) {
+  char filename[64];
+  size_t length;
+  GLint link_status = 0;
+  GlslShaderCache_Filename(filename, sizeof(filename), key);
+  uint8 *data = Platform_ReadWholeFile(filename, &length);
+  if (!data)
+    return false;
+  GlslCacheHeader *hdr = (GlslCacheHeader *)data;
+  if (length >= sizeof(GlslCacheHeader) && hdr->magic == kGlslCacheMagic &&
+      hdr->version == kGlslCacheVersion && hdr->key == key &&
+      hdr->length == length - sizeof(GlslCacheHeader)) {
+    glProgramBinary(program, hdr->binary_format, hdr + 1, hdr->length);
+    glGetProgramiv(program, GL_LINK_STATUS, &link_status);
+  }
+  free(data);
+  // The driver may reject binaries from an older build of itself
+  if (link_status != GL_TRUE)
+    remove(filename);
+  return link_status == GL_TRUE;
+}
+
+static void GlslShaderCache_Save(uint program, uint64 key) {
+  char filename[64];
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return;
+  GlslCacheHeader *hdr = malloc(sizeof(GlslCacheHeader) + length);
+  if (!hdr)
+    return;
+  GLenum binary_format = 0;
+  GLsizei written = 0;
+  glGetProgramBinary(program, length, &written, &binary_format, hdr + 1);
+  if (written > 0) {
+    hdr->magic = kGlslCacheMagic;
+    hdr->version = kGlslCacheVersion;
+    hdr->key = key;
+    hdr->binary_format = binary_format;
+    hdr->length = written;
+    GlslShaderCache_Filename(filename, sizeof(filename), key);
+    FILE *f = fopen(filename, "wb");
+    if (f) {
+      fwrite(hdr, 1, sizeof(GlslCacheHeader) + written, f);
+      fclose(f);
+    }
+  }
+  free(hdr);
+}
+
 GlslShader *GlslShader_CreateFromFile(const char *filename, bool opengl_es) {
   char buffer[256];
   GLint link_status;
   ByteArray shader_code = { 0 };
   bool success = false;
+  bool use_cache;
   GlslShader *gs = (GlslShader *)calloc(sizeof(GlslShader), 1);
   if (!gs)
     return gs;
@@ -417,6 +526,7 @@ GlslShader *GlslShader_CreateFromFile(const char *filename, bool opengl_es) {
       goto FAIL;
     }
   }
+  use_cache = GlslShaderCache_IsSupported();
   for (int i = 1; i <= gs->n_pass; i++) {
     GlslPass *p = gs->pass + i;
     shader_code.size = 0;
@@ -435,20 +545,27 @@ GlslShader *GlslShader_CreateFromFile(const char *filename, bool opengl_es) {
       goto FAIL;
     }
     p->gl_program = glCreateProgram();
-    if (!GlslPass_Compile(p, GL_VERTEX_SHADER, shader_code.data, shader_code.size, opengl_es) ||
-        !GlslPass_Compile(p, GL_FRAGMENT_SHADER, shader_code.data, shader_code.size, opengl_es)) {
-      goto FAIL;
-    }
-    glLinkProgram(p->gl_program);
-    glGetProgramiv(p->gl_program, GL_LINK_STATUS, &link_status);
-    buffer[0] = 0;
-    glGetProgramInfoLog(p->gl_program, sizeof(buffer), NULL, buffer);
-    if (link_status != GL_TRUE || buffer[0]) {
-      const char *severity = link_status != GL_TRUE ? "Error" : "While";
-      LogError("%s linking shader in file '%s':\n%s", severity, p->filename, buffer);
+    uint64 cache_key = use_cache ? GlslShaderCache_Key(shader_code.data, shader_code.size, opengl_es) : 0;
+    if (!use_cache || !GlslShaderCache_Load(p->gl_program, cache_key)) {
+      if (!GlslPass_Compile(p, GL_VERTEX_SHADER, shader_code.data, shader_code.size, opengl_es) ||
+          !GlslPass_Compile(p, GL_FRAGMENT_SHADER, shader_code.data, shader_code.size, opengl_es)) {
+        goto FAIL;
+      }
+      if (use_cache)
+        glProgramParameteri(p->gl_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+      glLinkProgram(p->gl_program);
+      glGetProgramiv(p->gl_program, GL_LINK_STATUS, &link_status);
+      buffer[0] = 0;
+      glGetProgramInfoLog(p->gl_program, sizeof(buffer), NULL, buffer);
+      if (link_status != GL_TRUE || buffer[0]) {
+        const char *severity = link_status != GL_TRUE ? "Error" : "While";
+        LogError("%s linking shader in file '%s':\n%s", severity, p->filename, buffer);
+      }
+      if (link_status != GL_TRUE)
+        goto FAIL;
+      if (use_cache)
+        GlslShaderCache_Save(p->gl_program, cache_key);
     }
-    if (link_status != GL_TRUE)
-      goto FAIL;
     glGenFramebuffers(1, &p->gl_fbo);
     glGenTextures(1, &p->gl_texture);
   }
@@ -531,11 +648,13 @@ typedef struct RenderCtx {
   uint vaos[kMaxVaosInRenderCtx];
 } RenderCtx;
 
-static void RenderCtx_SetTexture(RenderCtx *ctx, int textureu, uint texture_id) {
+static void RenderCtx_SetTexture(RenderCtx *ctx, int textureu, int *cur_unit, uint texture_id) {
   if (textureu >= 0) {
     glActiveTexture(GL_TEXTURE0 + ctx->texture_unit);
     glBindTexture(GL_TEXTURE_2D, texture_id);
-    glUniform1i(textureu, ctx->texture_unit++);
+    if (*cur_unit != (int)ctx->texture_unit)
+      glUniform1i(textureu, *cur_unit = ctx->texture_unit);
+    ctx->texture_unit++;
   }
 }
 
@@ -551,11 +670,14 @@ static void RenderCtx_SetTexCoords(RenderCtx *ctx, int tex_coord, uintptr_t offs
 static void RenderCtx_SetGlslTextureUniform(RenderCtx *ctx, GlslTextureUniform *u,
                                             int width, int height, uint texture) {
   float size[2] = { width, height };
-  RenderCtx_SetTexture(ctx, u->Texture, texture);
-  if (u->InputSize >= 0)
-    glUniform2fv(u->InputSize, 1, size);
-  if (u->TextureSize >= 0)
-    glUniform2fv(u->TextureSize, 1, size);
+  RenderCtx_SetTexture(ctx, u->Texture, &u->cur_unit, texture);
+  if (size[0] != u->cur_size[0] || size[1] != u->cur_size[1]) {
+    u->cur_size[0] = size[0], u->cur_size[1] = size[1];
+    if (u->InputSize >= 0)
+      glUniform2fv(u->InputSize, 1, size);
+    if (u->TextureSize >= 0)
+      glUniform2fv(u->TextureSize, 1, size);
+  }
   RenderCtx_SetTexCoords(ctx, u->TexCoord, ctx->offset);
 }
 
@@ -565,13 +687,20 @@ static void GlslShader_SetShaderVars(GlslShader *gs, RenderCtx *ctx, int pass) {
   RenderCtx_SetGlslTextureUniform(ctx, &p->unif.Top, p[-1].width, p[-1].height, p[-1].gl_texture);
   if (p->unif.OutputSize >= 0) {
     float output_size[2] = { (float)p[0].width, (float)p[0].height };
-    glUniform2fv(p->unif.OutputSize, 1, output_size);
+    if (output_size[0] != p->unif.cur_output_size[0] || output_size[1] != p->unif.cur_output_size[1]) {
+      p->unif.cur_output_size[0] = output_size[0], p->unif.cur_output_size[1] = output_size[1];
+      glUniform2fv(p->unif.OutputSize, 1, output_size);
+    }
   }
-  if (p->unif.FrameCount >= 0)
-    glUniform1i(p->unif.FrameCount, p->frame_count_mod ? 
-                gs->frame_count % p->frame_count_mod : gs->frame_count);
-  if (p->unif.FrameDirection >= 0)
+  if (p->unif.FrameCount >= 0) {
+    int frame_count = p->frame_count_mod ? gs->frame_count % p->frame_count_mod : gs->frame_count;
+    if (frame_count != p->unif.cur_frame_count)
+      glUniform1i(p->unif.FrameCount, p->unif.cur_frame_count = frame_count);
+  }
+  if (p->unif.FrameDirection >= 0 && !p->unif.frame_direction_set) {
+    p->unif.frame_direction_set = true;
     glUniform1i(p->unif.FrameDirection, 1);
+  }
   RenderCtx_SetTexCoords(ctx, p->unif.LUTTexCoord, ctx->offset);
   RenderCtx_SetTexCoords(ctx, p->unif.VertexCoord, 0);
   RenderCtx_SetGlslTextureUniform(ctx, &p->unif.Orig, gs->pass[0].width, gs->pass[0].height, gs->pass[0].gl_texture);
@@ -585,7 +714,7 @@ static void GlslShader_SetShaderVars(GlslShader *gs, RenderCtx *ctx, int pass) {
   // Texture uniforms
   int tctr = 0;
   for (GlslTexture *t = gs->first_texture; t; t = t->next, tctr++)
-    RenderCtx_SetTexture(ctx, p->unif.Texture[tctr], t->gl_texture);
+    RenderCtx_SetTexture(ctx, p->unif.Texture[tctr], &p->unif.TextureUnit[tctr], t->gl_texture);
   // PassX uniforms
   for (int i = 1; i < pass; i++)
     RenderCtx_SetGlslTextureUniform(ctx, &p->unif.Pass[i], gs->pass[i].width, gs->pass[i].height, gs->pass[i].gl_texture);
@@ -594,8 +723,8 @@ static void GlslShader_SetShaderVars(GlslShader *gs, RenderCtx *ctx, int pass) {
     RenderCtx_SetGlslTextureUniform(ctx, &p->unif.PassPrev[pass - i], gs->pass[i].width, gs->pass[i].height, gs->pass[i].gl_texture);
   // #parameter uniforms
   for (GlslParam *pa = gs->first_param; pa != NULL; pa = pa->next)
-    if (pa->uniform[pass] >= 0)
-      glUniform1f(pa->uniform[pass], pa->value);
+    if (pa->uniform[pass] >= 0 && pa->cur_value[pass] != pa->value)
+      glUniform1f(pa->uniform[pass], pa->cur_value[pass] = pa->value);
 
   glActiveTexture(GL_TEXTURE0);
 }
@@ -20,6 +20,9 @@ typedef struct GlslTextureUniform {
   int InputSize;
   int TextureSize;
   int TexCoord;
+  // Last values uploaded to the program, to skip redundant glUniform calls
+  int cur_unit;
+  float cur_size[2];
 } GlslTextureUniform;
 
 typedef struct GlslUniforms {
@@ -33,6 +36,10 @@ typedef struct GlslUniforms {
   GlslTextureUniform Pass[kGlslMaxPasses];
   GlslTextureUniform PassPrev[kGlslMaxPasses];
   int Texture[kGlslMaxTextures];
+  int TextureUnit[kGlslMaxTextures];
+  float cur_output_size[2];
+  int cur_frame_count;
+  bool frame_direction_set;
 } GlslUniforms;
 
 typedef struct GlslPass {
@@ -76,7 +83,8 @@ typedef struct GlslParam {
   float value;
   float min;
   float max;
-  uint uniform[kGlslMaxPasses];
+  uint uniform[kGlslMaxPasses + 1];
+  float cur_value[kGlslMaxPasses + 1];
 } GlslParam;
 
 typedef struct GlslShader {
@@ -328,22 +328,35 @@ static const uint8 *GetCompSpritePtr(int i) {
   return kSprGfx(i).ptr;
 }
 
-void ApplyPaletteFilter_bounce() {
+// Bit v is set if a color component with value v steps at the given countdown.
+// Each component of the aux color picks its own bit.
+static uint32 PaletteFilter_GetStepBits(uint16 countdown) {
+  const uint16 *load_ptr = kPaletteFilteringBits + (countdown >= 0x10);
+  int mask = kUpperBitmasks[countdown & 0xf];
+  uint32 bits = 0;
+  for (int v = 0; v < 32; v++) {
+    if (!(load_ptr[v * 2] & mask))
+      bits |= 1u << v;
+  }
+  return bits;
+}
 
-  const uint16 *load_ptr = kPaletteFilteringBits + (palette_filter_countdown >= 0x10);
+static inline int PaletteFilter_GetSteps(uint16 a, uint32 step_bits) {
+  return (step_bits >> (a & 0x1f) & 1) |
+         (step_bits >> (a >> 5 & 0x1f) & 1) << 5 |
+         (step_bits >> (a >> 10 & 0x1f) & 1) << 10;
+}
 
-  int mask = kUpperBitmasks[palette_filter_countdown & 0xf];
+static void PaletteFilter_StepColor(int j, uint32 step_bits, int dt) {
+  main_palette_buffer[j] += PaletteFilter_GetSteps(aux_palette_buffer[j], step_bits) * dt;
+}
+
+void ApplyPaletteFilter_bounce() {
+  uint32 step_bits = PaletteFilter_GetStepBits(palette_filter_countdown);
   int dt = darkening_or_lightening_screen ? 1 : -1;
   int j = 0;
   for (;;) {
-    uint16 c = main_palette_buffer[j], a = aux_palette_buffer[j];
-    if (!(load_ptr[(a & 0x1f) * 2] & mask))
-      c += dt;
-    if (!(load_ptr[(a & 0x3e0) >> 4] & mask))
-      c += dt << 5;
-    if (!(load_ptr[(a & 0x7c00) >> 9] & mask))
-      c += dt << 10;
-    main_palette_buffer[j] = c;
+    PaletteFilter_StepColor(j, step_bits, dt);
     j++;
     if (j == 1)
       j = 0x20;
@@ -366,19 +379,10 @@ void ApplyPaletteFilter_bounce() {
 }
 
 void PaletteFilter_Range(int from, int to) {
-  const uint16 *load_ptr = kPaletteFilteringBits + (palette_filter_countdown >= 0x10);
-  int mask = kUpperBitmasks[palette_filter_countdown & 0xf];
+  uint32 step_bits = PaletteFilter_GetStepBits(palette_filter_countdown);
   int dt = darkening_or_lightening_screen ? 1 : -1;
-  for (int j = from; j != to; j++) {
-    uint16 c = main_palette_buffer[j], a = aux_palette_buffer[j];
-    if (!(load_ptr[(a & 0x1f) * 2] & mask))
-      c += dt;
-    if (!(load_ptr[(a & 0x3e0) >> 4] & mask))
-      c += dt << 5;
-    if (!(load_ptr[(a & 0x7c00) >> 9] & mask))
-      c += dt << 10;
-    main_palette_buffer[j] = c;
-  }
+  for (int j = from; j != to; j++)
+    PaletteFilter_StepColor(j, step_bits, dt);
 }
 
 void PaletteFilter_IncrCountdown() {
@@ -1163,36 +1167,70 @@ void Palette_FadeIntro2() {  // 80ed8f
   flag_update_cgram_in_nmi++;
 }
 
+// One step for each component of c that doesn't match the target color d yet
+static inline uint16 PaletteFilter_RestoreSteps(uint16 c, uint16 d) {
+  uint16 x = c ^ d;
+  return ((x & 0x1f) != 0) | ((x & 0x3e0) != 0) << 5 | ((x & 0x7c00) != 0) << 10;
+}
+
 void PaletteFilter_RestoreAdditive(int from, int to) {  // 80edca
   from >>= 1, to >>= 1;
   do {
-    uint16 c = main_palette_buffer[from], cx = c;
-    uint16 d = aux_palette_buffer[from];
-    if ((c & 0x1f) != (d & 0x1f))
-      cx += 1;
-    if ((c & 0x3e0) != (d & 0x3e0))
-      cx += 0x20;
-    if ((c & 0x7c00) != (d & 0x7c00))
-      cx += 0x400;
-    main_palette_buffer[from] = cx;
+    main_palette_buffer[from] += PaletteFilter_RestoreSteps(main_palette_buffer[from], aux_palette_buffer[from]);
   } while (++from != to);
 }
 
 void PaletteFilter_RestoreSubtractive(uint16 from, uint16 to) {  // 80ee21
   from >>= 1, to >>= 1;
   do {
-    uint16 c = main_palette_buffer[from], cx = c;
-    uint16 d = aux_palette_buffer[from];
-    if ((c & 0x1f) != (d & 0x1f))
-      cx -= 1;
-    if ((c & 0x3e0) != (d & 0x3e0))
-      cx -= 0x20;
-    if ((c & 0x7c00) != (d & 0x7c00))
-      cx -= 0x400;
-    main_palette_buffer[from] = cx;
+    main_palette_buffer[from] -= PaletteFilter_RestoreSteps(main_palette_buffer[from], aux_palette_buffer[from]);
   } while (++from != to);
 }
 
+#ifndef NDEBUG
+// Compares the stepping above against the original one-component-at-a-time
+// code. The result is added to the main color, so checking the delta for
+// every countdown, direction and aux color (or every c ^ d for the restore
+// steps) covers all inputs. Run through ZeldaRunSelfTests.
+bool PaletteFilter_SelfTest() {
+  for (int countdown = 0; countdown < 0x20; countdown++) {
+    const uint16 *load_ptr = kPaletteFilteringBits + (countdown >= 0x10);
+    int mask = kUpperBitmasks[countdown & 0xf];
+    uint32 step_bits = PaletteFilter_GetStepBits(countdown);
+    for (int dt = -1; dt <= 1; dt += 2) {
+      for (int a = 0; a < 0x10000; a++) {
+        uint16 c = 0;
+        if (!(load_ptr[(a & 0x1f) * 2] & mask))
+          c += dt;
+        if (!(load_ptr[(a & 0x3e0) >> 4] & mask))
+          c += dt << 5;
+        if (!(load_ptr[(a & 0x7c00) >> 9] & mask))
+          c += dt << 10;
+        if (c != (uint16)(PaletteFilter_GetSteps(a, step_bits) * dt)) {
+          fprintf(stderr, "PaletteFilter: step mismatch for countdown %d, dt %d, color %.4X\n", countdown, dt, a);
+          return false;
+        }
+      }
+    }
+  }
+  for (int x = 0; x < 0x10000; x++) {
+    uint16 c = x, add = c, sub = c;
+    if (c & 0x1f)
+      add += 1, sub -= 1;
+    if (c & 0x3e0)
+      add += 0x20, sub -= 0x20;
+    if (c & 0x7c00)
+      add += 0x400, sub -= 0x400;
+    uint16 steps = PaletteFilter_RestoreSteps(c, 0);
+    if (add != (uint16)(c + steps) || sub != (uint16)(c - steps)) {
+      fprintf(stderr, "PaletteFilter: restore step mismatch for color %.4X\n", c);
+      return false;
+    }
+  }
+  return true;
+}
+#endif  // NDEBUG
+
 void PaletteFilter_InitializeWhiteFilter() {  // 80ee78
   for (int i = 0; i < 256; i++)
     aux_palette_buffer[i] = 0x7fff;
@@ -73,6 +73,9 @@ void Palette_FadeIntroOneStep();
 void Palette_FadeIntro2();
 void PaletteFilter_RestoreAdditive(int from, int to);
 void PaletteFilter_RestoreSubtractive(uint16 from, uint16 to);
+#ifndef NDEBUG
+bool PaletteFilter_SelfTest();
+#endif  // NDEBUG
 void PaletteFilter_InitializeWhiteFilter();
 void MirrorWarp_RunAnimationSubmodules();
 void PaletteFilter_BlindingWhite();
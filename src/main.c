@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <errno.h>
+#include <math.h>
 #include <SDL.h>
 
 #include "platform_detect.h"
@@ -176,6 +177,8 @@ static void DrawPpuFrameWithPerf() {
   g_renderer_funcs.BeginDraw(g_snes_width * render_scale,
                              g_snes_height * render_scale,
                              &pixel_buffer, &pitch);
+  if (!pixel_buffer)
+    return;  // the renderer couldn't provide a buffer, skip this frame
   if (g_display_perf || g_config.display_perf_title) {
     static float history[64], average;
     static int history_pos;
@@ -195,6 +198,124 @@ static void DrawPpuFrameWithPerf() {
   g_renderer_funcs.EndDraw();
 }
 
+// NTSC SNES: 21.477 MHz master clock, 357366 master cycles per frame.
+static const double kSnesFrameRate = 21477272.727 / 357366;
+
+// Paces frames against the performance counter. Sleeps for most of the wait
+// and spins for the last part, since SDL_Delay only has ms granularity and
+// often oversleeps. Deadlines advance by a fixed period so rounding errors
+// don't accumulate.
+typedef struct FramePacer {
+  double freq;
+  double period;
+  double deadline;
+  double spin_margin;
+  uint64 frame_start;
+  // Present is considered vsync throttled after 8 consecutive frames that
+  // already took a full period without sleeping, and stops being after 8 that
+  // didn't. This also keeps 120/144 Hz displays at the SNES rate, where each
+  // frame is then simply shown for several refreshes.
+  int vsync_votes;
+  bool vsync_throttled;
+  bool skip_stat;
+  uint32 stat_frames;
+  double stat_sum, stat_sum_sq, stat_worst;
+} FramePacer;
+
+static FramePacer g_pacer;
+
+static void FramePacer_Restart(FramePacer *fp) {
+  fp->frame_start = SDL_GetPerformanceCounter();
+  fp->deadline = fp->frame_start + fp->period;
+  fp->skip_stat = true;
+}
+
+static void FramePacer_Init(FramePacer *fp) {
+  fp->freq = (double)SDL_GetPerformanceFrequency();
+  fp->period = fp->freq / kSnesFrameRate;
+  fp->spin_margin = fp->freq * 0.002;
+  FramePacer_Restart(fp);
+}
+
+static void FramePacer_Wait(FramePacer *fp) {
+  uint64 now = SDL_GetPerformanceCounter();
+  double busy = (double)(now - fp->frame_start);
+
+  fp->vsync_votes = IntMax(IntMin(fp->vsync_votes + (busy >= fp->period * 0.95 ? 1 : -1), 8), 0);
+  if (fp->vsync_votes == 8)
+    fp->vsync_throttled = true;
+  else if (fp->vsync_votes == 0)
+    fp->vsync_throttled = false;
+
+  if (fp->vsync_throttled || now > fp->deadline + 4 * fp->period || now + 4 * fp->period < fp->deadline) {
+    // Don't sleep on top of a blocking present, and don't try to catch up
+    // after a long stall.
+    fp->deadline = (double)now;
+  } else if (now < fp->deadline) {
+    double remaining = fp->deadline - now;
+    if (remaining > fp->spin_margin) {
+      uint32 ms = (uint32)((remaining - fp->spin_margin) * 1000 / fp->freq);
+      uint64 before = SDL_GetPerformanceCounter();
+      SDL_Delay(ms);
+      // Adapt the spin margin to how much this system's SDL_Delay oversleeps
+      double oversleep = (double)(SDL_GetPerformanceCounter() - before) - ms * fp->freq / 1000;
+      double target = oversleep * 1.5;
+      fp->spin_margin += (target - fp->spin_margin) * (target > fp->spin_margin ? 0.5 : 1.0 / 64);
+      fp->spin_margin = fmin(fmax(fp->spin_margin, fp->freq * 0.0005), fp->freq * 0.004);
+    }
+    while ((now = SDL_GetPerformanceCounter()) < fp->deadline) {}
+  }
+  fp->deadline += fp->period;
+
+  if (!fp->skip_stat) {
+    double interval_ms = (now - fp->frame_start) * 1000 / fp->freq;
+    fp->stat_frames++;
+    fp->stat_sum += interval_ms;
+    fp->stat_sum_sq += interval_ms * interval_ms;
+    fp->stat_worst = fmax(fp->stat_worst, fabs(interval_ms - fp->period * 1000 / fp->freq));
+  }
+  fp->skip_stat = false;
+  fp->frame_start = now;
+}
+
+typedef struct FramePacerStats {
+  uint32 frames;
+  double target_ms, mean_ms, jitter_ms, worst_ms;
+  bool vsync_throttled;
+} FramePacerStats;
+
+// Frame interval statistics since startup, or since the last periodic report.
+// Returns false if no frame has been measured yet.
+static bool FramePacer_GetStats(const FramePacer *fp, FramePacerStats *st) {
+  if (fp->stat_frames == 0)
+    return false;
+  st->frames = fp->stat_frames;
+  st->target_ms = fp->period * 1000 / fp->freq;
+  st->mean_ms = fp->stat_sum / fp->stat_frames;
+  st->jitter_ms = sqrt(fmax(fp->stat_sum_sq / fp->stat_frames - st->mean_ms * st->mean_ms, 0.0));
+  st->worst_ms = fp->stat_worst;
+  st->vsync_throttled = fp->vsync_throttled;
+  return true;
+}
+
+static void FramePacer_LogStats(const FramePacer *fp) {
+  FramePacerStats st;
+  if (!FramePacer_GetStats(fp, &st))
+    return;
+  LogInfo("Frame pacing: %u frames, mean %.3f ms (target %.3f), jitter %.3f ms, worst %.3f ms, vsync throttled: %d",
+          st.frames, st.mean_ms, st.target_ms, st.jitter_ms, st.worst_ms, st.vsync_throttled);
+}
+
+// With LogFramePacing set, logs the statistics every that many seconds worth
+// of frames and starts over, so each line covers only the last interval.
+static void FramePacer_LogStatsPeriodically(FramePacer *fp, int seconds) {
+  if (seconds == 0 || fp->stat_frames < seconds * kSnesFrameRate)
+    return;
+  FramePacer_LogStats(fp);
+  fp->stat_frames = 0;
+  fp->stat_sum = fp->stat_sum_sq = fp->stat_worst = 0;
+}
+
 static SDL_mutex *g_audio_mutex;
 static uint8 *g_audiobuffer, *g_audiobuffer_cur, *g_audiobuffer_end;
 static int g_frames_per_block;
@@ -229,6 +350,23 @@ static SDL_Renderer *g_renderer;
 static SDL_Texture *g_texture;
 static SDL_Rect g_sdl_renderer_rect;
 
+// The ppu writes 32-bit xRGB, or xBGR with kPpuRenderFlags_SwapRedBlue.
+// Returns -1 for formats it can't produce without a conversion.
+static int SdlRenderer_PpuRedBlueOrder(uint32 format) {
+  return (format == SDL_PIXELFORMAT_ARGB8888 || format == SDL_PIXELFORMAT_RGB888) ? 0 :
+         (format == SDL_PIXELFORMAT_ABGR8888 || format == SDL_PIXELFORMAT_BGR888) ? 1 : -1;
+}
+
+// Use the renderer's most preferred format that the ppu can emit directly, so
+// SDL never converts the frame on unlock.
+static uint32 SdlRenderer_ChooseTextureFormat(const SDL_RendererInfo *info) {
+  for (uint32 i = 0; i < info->num_texture_formats; i++) {
+    if (SdlRenderer_PpuRedBlueOrder(info->texture_formats[i]) >= 0)
+      return info->texture_formats[i];
+  }
+  return SDL_PIXELFORMAT_ARGB8888;
+}
+
 static bool SdlRenderer_Init(SDL_Window *window) {
 
   if (g_config.shader)
@@ -255,8 +393,13 @@ static bool SdlRenderer_Init(SDL_Window *window) {
   if (g_config.linear_filtering)
     SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "best");
 
+  uint32 format = SdlRenderer_ChooseTextureFormat(&renderer_info);
+  if (SdlRenderer_PpuRedBlueOrder(format))
+    g_ppu_render_flags |= kPpuRenderFlags_SwapRedBlue;
+  LogDebug("Using texture format %s", SDL_GetPixelFormatName(format));
+
   int tex_mult = (g_ppu_render_flags & kPpuRenderFlags_4x4Mode7) ? 4 : 1;
-  g_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+  g_texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STREAMING,
                                 g_snes_width * tex_mult, g_snes_height * tex_mult);
   if (g_texture == NULL) {
     LogError("Failed to create texture: %s", SDL_GetError());
@@ -318,6 +461,11 @@ int main(int argc, char** argv) {
 #endif
   argc--, argv++;
 
+#ifndef NDEBUG
+  if (argc >= 1 && strcmp(argv[0], "--selftest") == 0)
+    return ZeldaRunSelfTests() ? 0 : 1;
+#endif  // NDEBUG
+
 #ifdef PLATFORM_ANDROID
   __android_log_print(ANDROID_LOG_DEBUG, "Zelda3Main", "About to InitializeLogging");
 #endif
@@ -547,14 +695,17 @@ int main(int argc, char** argv) {
 
   bool running = true;
   SDL_Event event;
-  uint32 lastTick = SDL_GetTicks();
-  uint32 curTick = 0;
   uint32 frameCtr = 0;
   bool audiopaused = true;
 
   if (g_config.autosave)
     HandleCommand(kKeys_Load + 0, true);
 
+  // The reports are info level, show them when they were asked for
+  if (g_config.log_frame_pacing && GetLogLevel() < LOG_INFO)
+    SetLogLevel(LOG_INFO);
+  FramePacer_Init(&g_pacer);
+
   while(running) {
     while(SDL_PollEvent(&event)) {
       switch(event.type) {
@@ -610,6 +761,7 @@ int main(int argc, char** argv) {
 
     if (g_paused) {
       SDL_Delay(16);
+      FramePacer_Restart(&g_pacer);
       continue;
     }
 
@@ -626,6 +778,7 @@ int main(int argc, char** argv) {
     frameCtr++;
 
     if ((g_turbo ^ (is_replay & g_replay_turbo)) && (frameCtr & (g_turbo ? 0xf : 0x7f)) != 0) {
+      FramePacer_Restart(&g_pacer);
       continue;
     }
 
@@ -638,25 +791,12 @@ int main(int argc, char** argv) {
     }
 
     // if vsync isn't working, delay manually
-    curTick = SDL_GetTicks();
-
     if (!g_config.disable_frame_delay) {
-      static const uint8 delays[3] = { 17, 17, 16 }; // 60 fps
-      lastTick += delays[frameCtr % 3];
-
-      if (lastTick > curTick) {
-        uint32 delta = lastTick - curTick;
-        if (delta > 500) {
-          lastTick = curTick - 500;
-          delta = 500;
-        }
-//        printf("Sleeping %d\n", delta);
-        SDL_Delay(delta);
-      } else if (curTick - lastTick > 500) {
-        lastTick = curTick;
-      }
+      FramePacer_Wait(&g_pacer);
+      FramePacer_LogStatsPeriodically(&g_pacer, g_config.log_frame_pacing);
     }
   }
+  FramePacer_LogStats(&g_pacer);
   if (g_config.autosave)
     HandleCommand(kKeys_Save + 0, true);
 
@@ -64,6 +64,18 @@ MATH_INLINE int CountBits32(uint32_t n) {
 #endif
 }
 
+// Index of the lowest set bit, n must be nonzero
+MATH_INLINE int LowestSetBit64(uint64_t n) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(n);
+#else
+  int i = 0;
+  for (; !(n & 1); i++)
+    n >>= 1;
+  return i;
+#endif
+}
+
 // Approximates atan2(y, x) normalized to the [0,4) range
 // Maximum error of 0.1620 degrees
 // Uses: normalized_atan(x) ~ (b x + x^2) / (1 + 2 b x + x^2)
@@ -103,7 +103,6 @@ static const uint16 kText_Positions[2] = {0x6125, 0x6244};
 static const uint16 kSrmOffsets[4] = {0, 0x500, 0xa00, 0xf00};
 static const int8 kText_InitializationData[32] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0x39, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x1c, 4, 0, 0, 0, 0, 0};
 static const uint16 kText_BorderTiles[9] = {0x28f3, 0x28f4, 0x68f3, 0x28c8, 0x387f, 0x68c8, 0xa8f3, 0xa8f4, 0xe8f3};
-static const uint8 kVWF_RenderCharacter_setMasks[8] = {0x80, 0x40, 0x20, 0x10, 8, 4, 2, 1};
 static const uint16 kVWF_RenderCharacter_renderPos[3] = {0, 0x2a0, 0x540};
 static const uint16 kVWF_RenderCharacter_linePositions[3] = {0, 0x40, 0x80};
 static const uint16 kVWF_RowPositions[3] = {0, 2, 4};
@@ -2505,6 +2504,22 @@ void RenderText_Draw_Finish() {  // 8eca35
   main_module_index = saved_module_for_menu;
 }
 
+// Draws one row of a 2bpp glyph starting at pixel bit_pos of the tile row at x.
+// Set glyph pixels toggle the buffer bit and clear ones reset it. The pixels
+// that don't fit spill into the next tile, replacing what's there.
+static void VWF_RenderGlyphRow(uint8 *mbuf, int x, int bit_pos, uint8 width, uint16 row) {
+  int n = 8 - bit_pos;
+  if (width != 0 && width < n)
+    n = width;
+  uint8 window = (0xff >> bit_pos) & ~(0xff >> (bit_pos + n));
+  uint8 lo = row, hi = row >> 8;
+  mbuf[x + 0] = (mbuf[x + 0] & ~window) | (~mbuf[x + 0] & (lo >> bit_pos) & window);
+  mbuf[x + 1] = (mbuf[x + 1] & ~window) | (~mbuf[x + 1] & (hi >> bit_pos) & window);
+  uint16 rest = (uint8)(lo << n) | (uint8)(hi << n) << 8;
+  if (rest != 0)
+    WORD(mbuf[x + 16]) = rest;
+}
+
 void VWF_RenderSingle(int c) {  // 8ecab8
   if (c != 0x59)
     sound_effect_2 = 12;
@@ -2525,53 +2540,13 @@ void VWF_RenderSingle(int c) {  // 8ecab8
   vwf_arr[i + 1] = arrval + width;
   uint16 r10 = (c & 0x70) * 2 + (c & 0xf);
   uint16 r0 = arrval * 2;
-  const uint16 *src2 = (uint16*)(kFontData + r10 * 16);
   uint8 *mbuf = (uint8 *)messaging_buf;
-  for (int i = 0; i != 16; i += 2) {
-    uint16 r4 = *src2++;
-    int y = r0 + vwf_line_ptr;
-    int x = (y & 0xff0) + i;
-    y = (y >> 1) & 7;
-    uint8 r3 = width;
-    do {
-      if (r4 & 0x0080)
-        mbuf[x + 0] ^= kVWF_RenderCharacter_setMasks[y];
-      else
-        mbuf[x + 0] &= ~kVWF_RenderCharacter_setMasks[y];
-      if (r4 & 0x8000)
-        mbuf[x + 1] ^= kVWF_RenderCharacter_setMasks[y];
-      else
-        mbuf[x + 1] &= ~kVWF_RenderCharacter_setMasks[y];
-      r4 = (r4 & ~0x8080) << 1;
-      //r4 <<= 1;
-    } while (--r3 && ++y != 8);
-    x += 16;
-    if (r4 != 0)
-      WORD(mbuf[x + 0]) = r4;
-  }
-  uint16 r8 = vwf_line_ptr + 0x150;
-  const uint16 *src3 = (uint16*)(kFontData + (r10 + 16) * 16);
-  for (int i = 0; i != 16; i += 2) {
-    uint16 r4 = *src3++;
-    int y = r8 + r0;
-    int x = (y & 0xff0) + i;
-    y = (y >> 1) & 7;
-    uint8 r3 = width;
-    do {
-      if (r4 & 0x0080)
-        mbuf[x + 0] ^= kVWF_RenderCharacter_setMasks[y];
-      else
-        mbuf[x + 0] &= ~kVWF_RenderCharacter_setMasks[y];
-      if (r4 & 0x8000)
-        mbuf[x + 1] ^= kVWF_RenderCharacter_setMasks[y];
-      else
-        mbuf[x + 1] &= ~kVWF_RenderCharacter_setMasks[y];
-      //r4 <<= 1;
-      r4 = (r4 & ~0x8080) << 1;
-    } while (--r3 && ++y != 8);
-    x += 16;
-    if (r4 != 0)
-      WORD(mbuf[x + 0]) = r4;
+  // Upper and lower halves of the glyph
+  for (int half = 0; half < 2; half++) {
+    const uint16 *src = (uint16 *)(kFontData + (r10 + half * 16) * 16);
+    int y = r0 + vwf_line_ptr + half * 0x150;
+    for (int i = 0; i != 16; i += 2)
+      VWF_RenderGlyphRow(mbuf, (y & 0xff0) + i, (y >> 1) & 7, width, *src++);
   }
 }
 
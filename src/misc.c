@@ -389,11 +389,12 @@ void NMI_PrepareSprites() {  // 8085fc
   static const uint16 kLinkDmaSources9[15] = { 0, 0x20, 0x40, 0, 0x20, 0x40, 0, 0x40, 0x80, 0, 0x40, 0x80, 0xb340, 0xb400, 0xb4c0 };
   static const uint16 kLinkDmaSources8[4] = { 0xa480, 0xa4c0, 0xa500, 0xa540 };
 
+  // Pack the four bytewise entries of each group with one 32-bit load. The
+  // masks keep exactly the bits the per-byte shifts would, so the result is
+  // the same even for entries above 3.
   for (int i = 0; i < 32; i++) {
-    extended_oam[i] = bytewise_extended_oam[3 + 4 * i] << 6 |
-      bytewise_extended_oam[2 + 4 * i] << 4 |
-      bytewise_extended_oam[1 + 4 * i] << 2 |
-      bytewise_extended_oam[0 + 4 * i] << 0;
+    uint32 v = DWORD(bytewise_extended_oam[4 * i]);
+    extended_oam[i] = v | (v >> 6 & 0xfc) | (v >> 12 & 0xf0) | (v >> 18 & 0xc0);
   }
 
   dma_source_addr_3 = kLinkDmaSources1[link_dma_graphics_index >> 1];
@@ -204,6 +204,8 @@ void NMI_DoUpdates() {  // 8089e0
     memcpy(&g_zenv.vram[animated_tile_vram_addr], &g_ram[animated_tile_data_src], 0x400);
   }
 
+  // Always the whole hud: the menu and dialog also write this BG3 tilemap, so
+  // an unchanged hud buffer doesn't mean vram still holds it.
   if (flag_update_hud_in_nmi) {
     memcpy(&g_zenv.vram[word_7E0219], hud_tile_indices_buffer, 165 * sizeof(uint16));
   }
@@ -215,7 +217,11 @@ void NMI_DoUpdates() {  // 8089e0
   flag_update_hud_in_nmi = 0;
   flag_update_cgram_in_nmi = 0;
 
-  memcpy(g_zenv.ppu->oam, &g_ram[0x800], 0x220);
+  // The ppu keeps its sprites binned by line, so only hand it oam that changed.
+  if (memcmp(g_zenv.ppu->oam, &g_ram[0x800], 0x220) != 0) {
+    memcpy(g_zenv.ppu->oam, &g_ram[0x800], 0x220);
+    g_zenv.ppu->spriteBinsValid = false;
+  }
 
   if (nmi_load_bg_from_vram) {
     const uint8 *p;
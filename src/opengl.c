@@ -20,6 +20,32 @@ static GlTextureWithSize g_texture;
 static GlslShader *g_glsl_shader;
 static bool g_opengl_es;
 
+// The ppu draws straight into a ring of pixel unpack buffers, so the texture
+// upload is queued on the gpu instead of copied from client memory during
+// glTexSubImage2D. With ARB_buffer_storage the buffers stay mapped and a fence
+// keeps a frame from being overwritten while it's still being uploaded,
+// otherwise each frame orphans its buffer and maps it again.
+enum { kPboRingSize = 3 };
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#define GL_ALREADY_SIGNALED 0x911A
+#define GL_CONDITION_SATISFIED 0x911C
+// A fence is three frames old when its buffer comes around again. If it still
+// hasn't signaled within another frame, that frame goes through client memory.
+enum { kPboFenceTimeoutNs = 16000000 };
+typedef GLsync (GL_APIENTRY *PFN_glFenceSync)(GLenum condition, GLbitfield flags);
+typedef GLenum (GL_APIENTRY *PFN_glClientWaitSync)(GLsync sync, GLbitfield flags, GLuint64 timeout);
+typedef void (GL_APIENTRY *PFN_glDeleteSync)(GLsync sync);
+static PFN_glFenceSync g_glFenceSync;
+static PFN_glClientWaitSync g_glClientWaitSync;
+static PFN_glDeleteSync g_glDeleteSync;
+static bool g_use_pbo, g_pbo_persistent, g_frame_in_pbo;
+static GLuint g_pbos[kPboRingSize];
+static uint8 *g_pbo_mapped[kPboRingSize];
+static GLsync g_pbo_fences[kPboRingSize];
+static size_t g_pbo_size;
+static int g_pbo_cur;
+
 static void GL_APIENTRY MessageCallback(GLenum source,
                 GLenum type,
                 GLuint id,
@@ -55,7 +81,16 @@ static bool OpenGLRenderer_Init(SDL_Window *window) {
     SDL_GL_GetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, &minorVersion);
     if (majorVersion < 3)
       Die("You need OpenGL ES 3.0");
-
+    // Program binaries are core in ES 3.0, but the loader only looks for them
+    // through the desktop ARB extension. The glsl shader cache uses them.
+    if (!glGetProgramBinary || !glProgramBinary || !glProgramParameteri) {
+      _ptrc_glGetProgramBinary = (void (CODEGEN_FUNCPTR *)(GLuint, GLsizei, GLsizei *, GLenum *, void *))
+          SDL_GL_GetProcAddress("glGetProgramBinary");
+      _ptrc_glProgramBinary = (void (CODEGEN_FUNCPTR *)(GLuint, GLenum, const void *, GLsizei))
+          SDL_GL_GetProcAddress("glProgramBinary");
+      _ptrc_glProgramParameteri = (void (CODEGEN_FUNCPTR *)(GLuint, GLenum, GLint))
+          SDL_GL_GetProcAddress("glProgramParameteri");
+    }
   }
 
   if (kDebugFlag) {
@@ -66,6 +101,18 @@ static bool OpenGLRenderer_Init(SDL_Window *window) {
 
   glGenTextures(1, &g_texture.gl_texture);
 
+  // The ppu buffer is also read back as a screenshot after the frame on GLES
+  // platforms, so it stays in client memory there.
+  if (!g_opengl_es) {
+    g_use_pbo = true;
+    g_glFenceSync = (PFN_glFenceSync)SDL_GL_GetProcAddress("glFenceSync");
+    g_glClientWaitSync = (PFN_glClientWaitSync)SDL_GL_GetProcAddress("glClientWaitSync");
+    g_glDeleteSync = (PFN_glDeleteSync)SDL_GL_GetProcAddress("glDeleteSync");
+    g_pbo_persistent = ogl_ext_ARB_buffer_storage == ogl_LOAD_SUCCEEDED && glBufferStorage &&
+        g_glFenceSync && g_glClientWaitSync && g_glDeleteSync;
+    glGenBuffers(kPboRingSize, g_pbos);
+  }
+
   static const float kVertices[] = {
     // positions          // texture coords
     -1.0f,  1.0f, 0.0f,   0.0f, 0.0f, // top left
@@ -178,7 +225,26 @@ static bool OpenGLRenderer_Init(SDL_Window *window) {
   return true;
 }
 
+static void OpenGLRenderer_ReleasePbos() {
+  for (int i = 0; i < kPboRingSize; i++) {
+    if (g_pbo_fences[i])
+      g_glDeleteSync(g_pbo_fences[i]), g_pbo_fences[i] = NULL;
+    if (g_pbo_mapped[i]) {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, g_pbos[i]);
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      g_pbo_mapped[i] = NULL;
+    }
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
 static void OpenGLRenderer_Destroy() {
+  if (g_use_pbo) {
+    OpenGLRenderer_ReleasePbos();
+    glDeleteBuffers(kPboRingSize, g_pbos);
+    g_pbo_size = 0;
+    g_use_pbo = g_frame_in_pbo = false;
+  }
 }
 
 static void OpenGLRenderer_OnResize(int width, int height) {
@@ -186,6 +252,50 @@ static void OpenGLRenderer_OnResize(int width, int height) {
   // No action needed - stub for interface compatibility
 }
 
+static void OpenGLRenderer_ResizePbos(size_t size) {
+  OpenGLRenderer_ReleasePbos();
+  // Buffer storage is immutable, so persistent buffers are recreated
+  if (g_pbo_persistent) {
+    glDeleteBuffers(kPboRingSize, g_pbos);
+    glGenBuffers(kPboRingSize, g_pbos);
+  }
+  for (int i = 0; i < kPboRingSize; i++) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, g_pbos[i]);
+    if (g_pbo_persistent) {
+      GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glBufferStorage(GL_PIXEL_UNPACK_BUFFER, size, NULL, flags);
+      g_pbo_mapped[i] = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, flags);
+    } else {
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+    }
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  g_pbo_size = size;
+}
+
+// Returns memory for the next frame in the pbo ring, or NULL to draw into g_screen_buffer
+static uint8 *OpenGLRenderer_MapPbo(size_t size) {
+  if (size > g_pbo_size)
+    OpenGLRenderer_ResizePbos(size);
+  g_pbo_cur = (g_pbo_cur + 1) % kPboRingSize;
+  if (g_pbo_persistent) {
+    GLsync fence = g_pbo_fences[g_pbo_cur];
+    if (fence) {
+      GLenum r = g_glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kPboFenceTimeoutNs);
+      if (r != GL_ALREADY_SIGNALED && r != GL_CONDITION_SATISFIED)
+        return NULL;
+      g_glDeleteSync(fence);
+      g_pbo_fences[g_pbo_cur] = NULL;
+    }
+    return g_pbo_mapped[g_pbo_cur];
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, g_pbos[g_pbo_cur]);
+  glBufferData(GL_PIXEL_UNPACK_BUFFER, g_pbo_size, NULL, GL_STREAM_DRAW);
+  uint8 *p = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  return p;
+}
+
 static void OpenGLRenderer_BeginDraw(int width, int height, uint8 **pixels, int *pitch) {
   // Check for integer overflow: width * height * 4
   // Maximum safe dimensions: sqrt(SIZE_MAX / 4) ≈ 2^31 on 64-bit, 2^15 on 32-bit
@@ -200,6 +310,19 @@ static void OpenGLRenderer_BeginDraw(int width, int height, uint8 **pixels, int
 
   size_t size = (size_t)width * (size_t)height;
 
+  g_draw_width = width;
+  g_draw_height = height;
+  *pitch = width * 4;
+  g_frame_in_pbo = false;
+  if (g_use_pbo) {
+    uint8 *p = OpenGLRenderer_MapPbo(size * 4);
+    if (p) {
+      g_frame_in_pbo = true;
+      *pixels = p;
+      return;
+    }
+  }
+
   if (size > g_screen_buffer_size) {
     g_screen_buffer_size = size;
     free(g_screen_buffer);
@@ -213,10 +336,7 @@ static void OpenGLRenderer_BeginDraw(int width, int height, uint8 **pixels, int
     }
   }
 
-  g_draw_width = width;
-  g_draw_height = height;
   *pixels = g_screen_buffer;
-  *pitch = width * 4;
 }
 
 static void OpenGLRenderer_EndDraw() {
@@ -236,19 +356,34 @@ static void OpenGLRenderer_EndDraw() {
   int viewport_x = (drawable_width - viewport_width) >> 1;
   int viewport_y = (drawable_height - viewport_height) >> 1;
 
+  // With a pbo bound, the pixel pointer is an offset into it
+  const uint8 *src = g_screen_buffer;
+  if (g_frame_in_pbo) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, g_pbos[g_pbo_cur]);
+    if (!g_pbo_persistent)
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    src = NULL;
+  }
+
   glBindTexture(GL_TEXTURE_2D, g_texture.gl_texture);
   if (g_draw_width == g_texture.width && g_draw_height == g_texture.height) {
     if (!g_opengl_es)
-      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, g_draw_width, g_draw_height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, g_screen_buffer);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, g_draw_width, g_draw_height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, src);
     else
-      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, g_draw_width, g_draw_height, GL_BGRA, GL_UNSIGNED_BYTE, g_screen_buffer);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, g_draw_width, g_draw_height, GL_BGRA, GL_UNSIGNED_BYTE, src);
   } else {
     g_texture.width = g_draw_width;
     g_texture.height = g_draw_height;
     if (!g_opengl_es)
-      glTexImage2D(GL_TEXTURE_2D, 0, GL_BGRA, g_draw_width, g_draw_height, 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, g_screen_buffer);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_BGRA, g_draw_width, g_draw_height, 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, src);
     else
-      glTexImage2D(GL_TEXTURE_2D, 0, GL_BGRA, g_draw_width, g_draw_height, 0, GL_BGRA, GL_UNSIGNED_BYTE, g_screen_buffer);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_BGRA, g_draw_width, g_draw_height, 0, GL_BGRA, GL_UNSIGNED_BYTE, src);
+  }
+
+  if (g_frame_in_pbo) {
+    if (g_pbo_persistent)
+      g_pbo_fences[g_pbo_cur] = g_glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
   }
 
   glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -9,6 +9,7 @@
 #include "misc.h"
 #include "messaging.h"
 #include "player_oam.h"
+#include "tile_detect.h"
 #include "snes/snes_regs.h"
 #include "assets.h"
 
@@ -247,6 +248,8 @@ const uint8 *GetMap8toTileAttr() {
   return kMap8DataToTileAttr;
 }
 
+// The table is already fully expanded, so callers index it directly rather
+// than keeping per-cell copies of its entries.
 const uint16 *GetMap16toMap8Table() {
   return kMap16ToMap8;
 }
@@ -2446,6 +2449,7 @@ void Overworld_DecompressAndDrawAllQuadrants() {  // 82f54a
   Overworld_DecompressAndDrawOneQuadrant((uint16 *)&g_ram[0x2040], si + 1);
   Overworld_DecompressAndDrawOneQuadrant((uint16 *)&g_ram[0x3000], si + 8);
   Overworld_DecompressAndDrawOneQuadrant((uint16 *)&g_ram[0x3040], si + 9);
+  Overworld_BuildTileAttrGrid();
 }
 
 static const uint8 *GetOverworldHibytes(int i) {
@@ -319,7 +319,9 @@ JNIEXPORT jbyteArray JNICALL Java_com_dishii_zelda3_MainActivity_nativeGetScreen
     // PPU outputs BGRA format, but Android Bitmap expects RGBA
     // We need to swap B and R channels
     // Also need to account for extraLeftRight offset in the buffer
+    // (unless the renderer asked the PPU for xBGR output already)
     int extraLeftRight = g_zenv.ppu->extraLeftRight;
+    int r_index = (g_zenv.ppu->renderFlags & kPpuRenderFlags_SwapRedBlue) ? 0 : 2;
     LOGD("nativeGetScreenshotRGBA: extraLeftRight=%d", extraLeftRight);
 
     for (int y = 0; y < height; y++) {
@@ -328,9 +330,9 @@ JNIEXPORT jbyteArray JNICALL Java_com_dishii_zelda3_MainActivity_nativeGetScreen
         uint8_t *dst = (uint8_t*)resultData + (y * width * 4);
 
         for (int x = 0; x < width; x++) {
-            dst[x * 4 + 0] = src[x * 4 + 2];  // R from B
-            dst[x * 4 + 1] = src[x * 4 + 1];  // G stays G
-            dst[x * 4 + 2] = src[x * 4 + 0];  // B from R
+            dst[x * 4 + 0] = src[x * 4 + r_index];      // R
+            dst[x * 4 + 1] = src[x * 4 + 1];            // G stays G
+            dst[x * 4 + 2] = src[x * 4 + 2 - r_index];  // B
             dst[x * 4 + 3] = 0xFF;             // Alpha (PPU outputs 0, we want opaque)
         }
     }
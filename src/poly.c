@@ -238,6 +238,10 @@ void Polyhedral_DrawFace() {  // 89fd1e
   }
 }
 
+// Fills a span of one line directly in the 2bpp tile layout, a whole 8-pixel
+// row word at a time, with masks only for the two edge tiles. A linear staging
+// buffer would just add a conversion pass, and poly_tmp1, poly_tmp2 and
+// poly_raster_numfull are part of the RAM state that replays compare.
 void Polyhedral_FillLine() {  // 89fdcf
   uint16 left = kPoly_LeftSideMask[(poly_x0_frac >> 8) & 7];
   uint16 right = kPoly_RightSideMask[(poly_x1_frac >> 8) & 7];
@@ -2031,6 +2031,9 @@ bool Sprite_CheckTileProperty(int k, int j) {  // 86e73c
   return true;
 }
 
+// Both paths are a single table read (the overworld one goes through the
+// cached attribute grid), so probes are not memoized per sprite. Callers rely
+// on sprite_tiletype being written by every probe.
 uint8 GetTileAttribute(uint8 floor, uint16 *x, uint16 y) {  // 86e87b
   uint8 tiletype;
   if (player_is_indoors) {
@@ -2955,6 +2958,9 @@ void Sprite_SetupHitBox(int k, SpriteHitBox *hb) {  // 86f7ef
   hb->r7_spr_ysize = kSpriteHitbox_YSize[i];
 }
 
+// Hit tests against other sprites scan the 16 slots directly. A spatial
+// broadphase has to be revalidated whenever a hit moves or spawns sprites
+// mid-loop, which made each query several times slower than the scan.
 // Returns the carry flag
 bool CheckIfHitBoxesOverlap(SpriteHitBox *hb) {  // 86f836
   int t;
@@ -3621,6 +3627,7 @@ void Dungeon_ResetSprites() {  // 89c114
     if (blk != 0xffff)
       sprite_where_in_room[blk] = 0;
   }
+  Sprite_InvalidateOverworldIndex();
   Dungeon_LoadSprites();
 }
 
@@ -3700,6 +3707,7 @@ void Sprite_ManuallySetDeathFlagUW(int k) {  // 89c2f5
   if (!player_is_indoors || sprite_defl_bits[k] & 1 || sign8(sprite_N[k]))
     return;
   sprite_where_in_room[dungeon_room_index2] |= 1 << sprite_N[k];
+  Sprite_InvalidateOverworldIndex();
 }
 
 int Dungeon_LoadSingleSprite(int k, const uint8 *src) {  // 89c327
@@ -3771,6 +3779,7 @@ void Sprite_ResetAll_noDisable() {  // 89c452
     super_bomb_indicator_unk2 = 0xfe;
   memset(sprite_where_in_room, 0, 0x1000);
   memset(overworld_sprite_was_loaded, 0, 0x200);
+  Sprite_InvalidateOverworldIndex();
   memset(dungeon_room_history, 0xff, 8);
 }
 
@@ -3785,6 +3794,68 @@ void Sprite_OverworldReloadAll_justLoad() {  // 89c49d
   Sprite_ActivateAllProxima();
 }
 
+// Occupancy bitmaps of the current area's sprite placements with one bit per
+// 16x16 cell, so the edge strips probed while scrolling only visit cells that
+// actually have something placed in sprite_where_in_overworld. The index
+// only covers areas up to 64x64 cells, and must be invalidated whenever that
+// RAM (shared with sprite_where_in_room) is rewritten outside
+// Overworld_LoadSprites.
+static struct {
+  uint16 area_plus1;
+  uint64 cols[64];  // bit y of cols[x]
+  uint64 rows[64];  // bit x of rows[y]
+} g_ow_sprite_index;
+
+static void Overworld_BuildSpriteIndex() {
+  memset(&g_ow_sprite_index, 0, sizeof(g_ow_sprite_index));
+  for (int blk = 0; blk < 0x1000; blk++) {
+    if (sprite_where_in_overworld[blk]) {
+      int x = (blk >> 8 & 3) << 4 | (blk & 0xf);
+      int y = (blk >> 10) << 4 | (blk >> 4 & 0xf);
+      g_ow_sprite_index.cols[x] |= 1ull << y;
+      g_ow_sprite_index.rows[y] |= 1ull << x;
+    }
+  }
+  g_ow_sprite_index.area_plus1 = overworld_area_index + 1;
+}
+
+void Sprite_InvalidateOverworldIndex() {
+  g_ow_sprite_index.area_plus1 = 0;
+}
+
+// Same as calling Sprite_Overworld_ProximityMotivatedLoad on n cells 16 pixels
+// apart starting at x,y, stepping along x if horizontal, else along y.
+static void Sprite_Overworld_ProximityLoadStrip(uint16 x, uint16 y, int n, bool horizontal) {
+  // Dungeons and the ending leave the sizes at 0xffff, which the index can't
+  // represent, so take the slow path there.
+  if (sprcoll_x_size > 0x400 || sprcoll_y_size > 0x400) {
+    for (int i = 0; i < n; i++)
+      Sprite_Overworld_ProximityMotivatedLoad(horizontal ? x + i * 16 : x, horizontal ? y : y + i * 16);
+    return;
+  }
+  if (g_ow_sprite_index.area_plus1 != (uint16)(overworld_area_index + 1))
+    Overworld_BuildSpriteIndex();
+  uint16 xt = (uint16)(x - sprcoll_x_base);
+  uint16 yt = (uint16)(y - sprcoll_y_base);
+  uint16 fixed = horizontal ? yt : xt, t = horizontal ? xt : yt;
+  if (fixed >= (horizontal ? sprcoll_y_size : sprcoll_x_size))
+    return;
+  // Cells along the strip wrap around at 0x10000 pixels.
+  int c = t >> 4, end = c + n;
+  if (end > 0x1000)
+    c = 0, end -= 0x1000;
+  end = IntMin(end, (horizontal ? sprcoll_x_size : sprcoll_y_size) >> 4);
+  if (c >= end)
+    return;
+  uint64 line = horizontal ? g_ow_sprite_index.rows[fixed >> 4] : g_ow_sprite_index.cols[fixed >> 4];
+  line &= (~0ull << c) & (end >= 64 ? ~0ull : (1ull << end) - 1);
+  for (; line; line &= line - 1) {
+    int i = LowestSetBit64(line);
+    int cx = horizontal ? i : fixed >> 4, cy = horizontal ? fixed >> 4 : i;
+    Overworld_LoadProximaSpriteIfAlive((cy >> 4) << 10 | (cx >> 4) << 8 | (cy & 0xf) << 4 | (cx & 0xf));
+  }
+}
+
 void Overworld_LoadSprites() {  // 89c4ac
   sprcoll_x_base = (overworld_area_index & 7) << 9;
   sprcoll_y_base = ((overworld_area_index & 0x3f) >> 2 & 0xe) << 8;
@@ -3802,6 +3873,7 @@ void Overworld_LoadSprites() {  // 89c4ac
     uint8 r5 = src[1] & 0xf | src[0] << 4;
     sprite_where_in_overworld[r5 | r6 << 8] = src[2] + 1;
   }
+  Overworld_BuildSpriteIndex();
 }
 
 void Sprite_ActivateAllProxima() {  // 89c55e
@@ -3837,8 +3909,7 @@ void Sprite_ActivateWhenProximal() {  // 89c5bb
     int xt = (enhanced_features0 & kFeatures0_ExtendScreen64) ? 0x40 : 0;
     uint16 x = BG2HOFS_copy2 + (sign8(byte_7E069E[1]) ? -0x10 - xt : 0x110 + xt);
     uint16 y = BG2VOFS_copy2 - 0x30;
-    for (int i = 21; i >= 0; i--, y += 16)
-      Sprite_Overworld_ProximityMotivatedLoad(x, y);
+    Sprite_Overworld_ProximityLoadStrip(x, y, 22, false);
   }
 }
 
@@ -3847,8 +3918,7 @@ void Sprite_ActivateWhenProximalBig() {  // 89c5fa
     int xt = (enhanced_features0 & kFeatures0_ExtendScreen64) ? 0x40 : 0;
     uint16 x = BG2HOFS_copy2 - 0x30 - xt;
     uint16 y = BG2VOFS_copy2 + (sign8(byte_7E069E[0]) ? -0x10 : 0x110);
-    for (int i = 21 + (xt >> 3); i >= 0; i--, x += 16)
-      Sprite_Overworld_ProximityMotivatedLoad(x, y);
+    Sprite_Overworld_ProximityLoadStrip(x, y, 22 + (xt >> 3), true);
   }
 }
 
@@ -268,6 +268,7 @@ void Dungeon_CacheTransSprites();
 void Sprite_DisableAll();
 void Dungeon_LoadSprites();
 void Sprite_ManuallySetDeathFlagUW(int k);
+void Sprite_InvalidateOverworldIndex();
 int Dungeon_LoadSingleSprite(int k, const uint8 *src);
 void Dungeon_LoadSingleOverlord(const uint8 *src);
 void Sprite_ResetAll();
@@ -11,21 +11,45 @@ static const uint8 kDetectTiles_tab3[] = { 15, 15, 23, 23 };
 static const int8 kDetectTiles_tab4[] = { 7, 24, -1, 16 };
 static const uint8 kDetectTiles_tab5[] = { 0, 0, 8, 8 };
 static const uint8 kDetectTiles_tab6[] = { 15, 15, 23, 23 };
+// Flat 8x8 attribute grid for the current overworld area. Each map16 cell
+// caches the four final attributes together with the map16 value they were
+// expanded from, so tile changes (bushes, rocks, bombable walls, snapshot
+// loads) are picked up on the next probe without patching every writer.
+typedef struct OwTileAttrCell {
+  uint16 map16_plus1;  // 0 means the cell was never built
+  uint8 attr[4];
+} OwTileAttrCell;
+static OwTileAttrCell g_ow_tileattr_cells[0x1000];
+
+static void Overworld_BuildTileAttrCell(OwTileAttrCell *c, uint16 map16) {
+  const uint16 *map8 = GetMap16toMap8Table() + map16 * 4;
+  const uint8 *attr = GetMap8toTileAttr();
+  for (int i = 0; i < 4; i++) {
+    uint16 t = map8[i];
+    uint8 rv = attr[t & 0x1ff];
+    if (rv >= 0x10 && rv < 0x1C)
+      rv |= (t >> 14) & 1;
+    c->attr[i] = rv;
+  }
+  c->map16_plus1 = map16 + 1;
+}
+
+void Overworld_BuildTileAttrGrid() {
+  for (int i = 0; i < countof(g_ow_tileattr_cells); i++)
+    Overworld_BuildTileAttrCell(&g_ow_tileattr_cells[i], overworld_tileattr[i]);
+}
+
 uint8 Overworld_GetTileAttributeAtLocation(uint16 x, uint16 y) {  // 80882e
   uint16 t;
 
   t = ((y - overworld_offset_base_y) & overworld_offset_mask_y) * 8;
   t |= ((x - overworld_offset_base_x) & overworld_offset_mask_x);
-  t = overworld_tileattr[t >> 1] * 4;
-  t |= (y & 8) >> 2;
-  t |= (x & 1);
-  t = GetMap16toMap8Table()[t];
-
-  uint8 rv = GetMap8toTileAttr()[t & 0x1ff];
-  if (rv >= 0x10 && rv < 0x1C) {
-    rv |= (t >> 14) & 1;
-  }
-  return rv;
+  t >>= 1;
+  OwTileAttrCell *c = &g_ow_tileattr_cells[t];
+  uint16 map16 = overworld_tileattr[t];
+  if (c->map16_plus1 != (uint16)(map16 + 1))
+    Overworld_BuildTileAttrCell(c, map16);
+  return c->attr[(y & 8) >> 2 | (x & 1)];
 }
 
 void TileDetect_Movement_Y(uint16 direction) {  // 87cdcb
@@ -253,7 +277,324 @@ void TileDetection_Execute(uint16 x, uint16 y, uint16 bits) {  // 87d9d8
   TileDetect_ExecuteInner(tile, offs, bits, player_is_indoors);
 }
 
+// Bitfields that tile behaviors OR the probe bits into. Low 5 bits of an op
+// select the field, the upper bits select the shift (bits << 4 * n).
+enum {
+  kTdf_None,
+  kTdf_R12,
+  kTdf_R14,
+  kTdf_DiagonalTile,
+  kTdf_StairTile,
+  kTdf_InroomStaircase,
+  kTdf_MovingFloor,
+  kTdf_DeepWater,
+  kTdf_NormalTiles,
+  kTdf_IcyFloor,
+  kTdf_WaterStaircase,
+  kTdf_ThickGrass,
+  kTdf_ShallowWater,
+  kTdf_DestructionAftermath,
+  kTdf_VerticalLedge,
+  kTdf_HorizLedge,
+  kTdf_LedgeDownLeftRight,
+  kTdf_UnknownTileTypes,
+  kTdf_Chest,
+  kTdf_KeyLockGravestones,
+  kTdf_SpikeCactus,
+  kTdf_SpikeFloorTriggers,
+  kTdf_Dashable,
+  kTdf_MiscTiles,
+  kTdf_Var4,
+
+  kTdf_Shl4 = 1 << 5,
+  kTdf_Shl8 = 2 << 5,
+  kTdf_Shl12 = 3 << 5,
+};
+
+// Special-case handlers for the tiles whose effect is more than a plain OR.
+enum {
+  kTdh_None,
+  kTdh_Interact,
+  kTdh_Slope,
+  kTdh_SpikeFloor,
+  kTdh_Pit,
+  kTdh_Spike,
+  kTdh_Liftable,
+  kTdh_Chest,
+  kTdh_RupeeTile,
+  kTdh_ManipulablyReplaced,
+  kTdh_Door,
+  kTdh_LayerToggleShutterDoor,
+  kTdh_DungeonToggleDoor,
+  kTdh_LayerAndDungeonToggleShutterDoor,
+  kTdh_Entrance,
+};
+
+typedef struct TileDetectField {
+  void *ptr;
+  bool is_byte;
+} TileDetectField;
+
+static const TileDetectField kTileDetectFields[] = {
+  {NULL, false},
+  {&g_r12, false},
+  {&g_r14, false},
+  {&tiledetect_diagonal_tile, false},
+  {&tiledetect_stair_tile, true},
+  {&tiledetect_inroom_staircase, false},
+  {&tiledetect_moving_floor_tiles, false},
+  {&tiledetect_deepwater, false},
+  {&tiledetect_normal_tiles, false},
+  {&tiledetect_icy_floor, false},
+  {&tiledetect_water_staircase, false},
+  {&tiledetect_thick_grass, false},
+  {&tiledetect_shallow_water, false},
+  {&tiledetect_destruction_aftermath, false},
+  {&tiledetect_vertical_ledge, true},
+  {&detection_of_ledge_tiles_horiz_uphoriz, true},
+  {&tiledetect_ledges_down_leftright, true},
+  {&detection_of_unknown_tile_types, true},
+  {&tiledetect_chest, false},
+  {&tiledetect_key_lock_gravestones, true},
+  {&bitfield_spike_cactus_tiles, true},
+  {&tiledetect_spike_floor_and_tile_triggers, true},
+  {&bitmask_for_dashable_tiles, true},
+  {&tiledetect_misc_tiles, false},
+  {&tiledetect_var4, false},
+};
+
+typedef struct TileBehavior {
+  uint8 ops[3];
+  uint8 handler;
+} TileBehavior;
+
+enum {
+  kTdm_Outdoors = 1,
+  kTdm_Indoors = 2,
+  kTdm_Both = 3,
+};
+
+typedef struct TileBehaviorRule {
+  uint8 first, last, modes;
+  TileBehavior behavior;
+} TileBehaviorRule;
+
+// Mirrors the original 87dc2e jump tables. Later rules override earlier ones,
+// tiles not listed for a mode have no effect. The emulated-CPU verification
+// only catches mistakes here for tiles that come up in play, so run
+// --selftest in a debug build after changing them.
+static const TileBehaviorRule kTileBehaviorRules[] = {
+  // TileBehavior_NothingOW
+  {0x00, 0x00, kTdm_Outdoors, {{kTdf_NormalTiles}}},
+  {0x05, 0x07, kTdm_Outdoors, {{kTdf_NormalTiles}}},
+  {0x14, 0x17, kTdm_Outdoors, {{kTdf_NormalTiles}}},
+  {0x21, 0x21, kTdm_Outdoors, {{kTdf_NormalTiles}}},
+  {0x23, 0x25, kTdm_Outdoors, {{kTdf_NormalTiles}}},
+  {0x38, 0x3c, kTdm_Outdoors, {{kTdf_NormalTiles}}},
+  {0x41, 0x41, kTdm_Outdoors, {{kTdf_NormalTiles}}},
+  {0x45, 0x45, kTdm_Outdoors, {{kTdf_NormalTiles}}},
+  {0x47, 0x47, kTdm_Outdoors, {{kTdf_NormalTiles}}},
+  {0x49, 0x49, kTdm_Outdoors, {{kTdf_NormalTiles}}},
+  {0x5e, 0x5f, kTdm_Outdoors, {{kTdf_NormalTiles}}},
+  {0x61, 0x62, kTdm_Outdoors, {{kTdf_NormalTiles}}},
+  {0x64, 0x66, kTdm_Outdoors, {{kTdf_NormalTiles}}},
+  {0xa6, 0xa7, kTdm_Outdoors, {{kTdf_NormalTiles}}},
+  {0xbe, 0xbf, kTdm_Outdoors, {{kTdf_NormalTiles}}},
+  {0xd0, 0xef, kTdm_Outdoors, {{kTdf_NormalTiles}}},
+  // TileBehavior_StandardCollision
+  {0x01, 0x03, kTdm_Both, {{kTdf_R14}}},
+  {0x26, 0x26, kTdm_Both, {{kTdf_R14}}},
+  {0x43, 0x43, kTdm_Both, {{kTdf_R14}}},
+  {0x6c, 0x6f, kTdm_Indoors, {{kTdf_R14}}},
+  {0x6c, 0x6f, kTdm_Outdoors, {{kTdf_NormalTiles}}},
+  {0x04, 0x04, kTdm_Indoors, {{kTdf_R14}}},
+  {0x04, 0x04, kTdm_Outdoors, {{kTdf_ThickGrass}}},
+  {0x0b, 0x0b, kTdm_Indoors, {{kTdf_R14}}},
+  {0x0b, 0x0b, kTdm_Outdoors, {{kTdf_DeepWater | kTdf_Shl4}, kTdh_Interact}},
+  {0x08, 0x08, kTdm_Both, {{kTdf_DeepWater}}},
+  {0x09, 0x09, kTdm_Both, {{kTdf_ShallowWater}}},
+  {0x0a, 0x0a, kTdm_Both, {{kTdf_NormalTiles}}},
+  {0x0c, 0x0c, kTdm_Both, {{kTdf_MovingFloor}}},
+  {0x0d, 0x0d, kTdm_Both, {{0}, kTdh_SpikeFloor}},
+  {0x0e, 0x0e, kTdm_Both, {{kTdf_IcyFloor}}},
+  {0x0f, 0x0f, kTdm_Both, {{kTdf_IcyFloor | kTdf_Shl4}}},
+  {0x10, 0x13, kTdm_Both, {{kTdf_R12}, kTdh_Slope}},
+  {0x18, 0x1b, kTdm_Both, {{kTdf_DiagonalTile, kTdf_R12}, kTdh_Slope}},
+  {0x1c, 0x1c, kTdm_Both, {{kTdf_WaterStaircase}}},
+  {0x1d, 0x1f, kTdm_Both, {{kTdf_InroomStaircase, kTdf_StairTile}, kTdh_Interact}},
+  {0x20, 0x20, kTdm_Both, {{0}, kTdh_Pit}},
+  {0xb0, 0xbd, kTdm_Both, {{0}, kTdh_Pit}},
+  {0x22, 0x22, kTdm_Both, {{kTdf_StairTile}}},
+  {0x30, 0x37, kTdm_Both, {{kTdf_StairTile}}},
+  {0x27, 0x27, kTdm_Both, {{kTdf_R14, kTdf_MiscTiles}}},
+  {0x28, 0x28, kTdm_Both, {{kTdf_VerticalLedge}, kTdh_Interact}},
+  {0x29, 0x29, kTdm_Both, {{kTdf_VerticalLedge | kTdf_Shl4}, kTdh_Interact}},
+  {0x2a, 0x2b, kTdm_Both, {{kTdf_HorizLedge}, kTdh_Interact}},
+  {0x2c, 0x2c, kTdm_Both, {{kTdf_HorizLedge | kTdf_Shl4}, kTdh_Interact}},
+  {0x2e, 0x2e, kTdm_Both, {{kTdf_HorizLedge | kTdf_Shl4}, kTdh_Interact}},
+  {0x2d, 0x2d, kTdm_Both, {{kTdf_LedgeDownLeftRight}, kTdh_Interact}},
+  {0x2f, 0x2f, kTdm_Both, {{kTdf_LedgeDownLeftRight}, kTdh_Interact}},
+  {0x3d, 0x3f, kTdm_Both, {{kTdf_InroomStaircase | kTdf_Shl4, kTdf_StairTile}, kTdh_Interact}},
+  {0x40, 0x40, kTdm_Both, {{kTdf_ThickGrass}}},
+  {0x42, 0x42, kTdm_Outdoors, {{kTdf_KeyLockGravestones, kTdf_R14}}},
+  {0x44, 0x44, kTdm_Both, {{0}, kTdh_Spike}},
+  {0x46, 0x46, kTdm_Both, {{kTdf_SpikeFloorTriggers, kTdf_R14}}},
+  {0x48, 0x48, kTdm_Both, {{kTdf_DestructionAftermath, kTdf_NormalTiles}}},
+  {0x4a, 0x4a, kTdm_Both, {{kTdf_DestructionAftermath, kTdf_NormalTiles}}},
+  {0x4b, 0x4b, kTdm_Both, {{kTdf_ThickGrass | kTdf_Shl4}}},
+  {0x4c, 0x4d, kTdm_Outdoors, {{kTdf_UnknownTileTypes}, kTdh_Interact}},
+  {0x4e, 0x4f, kTdm_Outdoors, {{kTdf_UnknownTileTypes | kTdf_Shl4}, kTdh_Interact}},
+  {0x50, 0x56, kTdm_Both, {{0}, kTdh_Liftable}},
+  {0x57, 0x57, kTdm_Both, {{kTdf_R14, kTdf_Dashable | kTdf_Shl4}}},
+  {0x58, 0x5d, kTdm_Both, {{0}, kTdh_Chest}},
+  {0x60, 0x60, kTdm_Indoors, {{0}, kTdh_RupeeTile}},
+  {0x60, 0x60, kTdm_Outdoors, {{kTdf_NormalTiles}}},
+  {0x63, 0x63, kTdm_Both, {{kTdf_MiscTiles, kTdf_Chest, kTdf_R14}, kTdh_Interact}},
+  {0x67, 0x67, kTdm_Both, {{kTdf_R14, kTdf_MiscTiles, kTdf_SpikeCactus | kTdf_Shl4}}},
+  {0x68, 0x68, kTdm_Both, {{kTdf_Var4}}},
+  {0x69, 0x69, kTdm_Both, {{kTdf_Var4 | kTdf_Shl4}}},
+  {0x6a, 0x6a, kTdm_Both, {{kTdf_Var4 | kTdf_Shl8}}},
+  {0x6b, 0x6b, kTdm_Both, {{kTdf_Var4 | kTdf_Shl12}}},
+  {0x70, 0x7f, kTdm_Both, {{kTdf_R14, kTdf_MiscTiles}, kTdh_ManipulablyReplaced}},
+  {0x80, 0x8d, kTdm_Both, {{kTdf_R14 | kTdf_Shl4}, kTdh_Door}},
+  {0x82, 0x83, kTdm_Both, {{kTdf_R14 | kTdf_Shl4, kTdf_R14 | kTdf_Shl8}, kTdh_Door}},
+  {0x8e, 0x8f, kTdm_Both, {{kTdf_R14 | kTdf_Shl4, kTdf_Dashable}, kTdh_Entrance}},
+  {0x90, 0x97, kTdm_Both, {{kTdf_R14 | kTdf_Shl4, kTdf_R14 | kTdf_Shl8}, kTdh_LayerToggleShutterDoor}},
+  {0x98, 0x9f, kTdm_Both, {{kTdf_R14 | kTdf_Shl4, kTdf_R14 | kTdf_Shl8}, kTdh_LayerAndDungeonToggleShutterDoor}},
+  {0xa8, 0xaf, kTdm_Both, {{kTdf_R14 | kTdf_Shl4, kTdf_R14 | kTdf_Shl8}, kTdh_LayerAndDungeonToggleShutterDoor}},
+  {0xa0, 0xa5, kTdm_Both, {{kTdf_R14 | kTdf_Shl4}, kTdh_DungeonToggleDoor}},
+  {0xa2, 0xa3, kTdm_Both, {{kTdf_R14 | kTdf_Shl4, kTdf_R14 | kTdf_Shl8}, kTdh_DungeonToggleDoor}},
+  {0xc0, 0xcf, kTdm_Both, {{kTdf_R14, kTdf_MiscTiles}}},
+  {0xf0, 0xff, kTdm_Both, {{kTdf_R14, kTdf_MiscTiles | kTdf_Shl4}}},
+};
+
+static TileBehavior g_tile_behaviors[2][256];  // [is_indoors][tile]
+
+void TileDetect_InitBehaviorTable() {
+  for (int i = 0; i < countof(kTileBehaviorRules); i++) {
+    const TileBehaviorRule *r = &kTileBehaviorRules[i];
+    for (int t = r->first; t <= r->last; t++) {
+      if (r->modes & kTdm_Outdoors)
+        g_tile_behaviors[0][t] = r->behavior;
+      if (r->modes & kTdm_Indoors)
+        g_tile_behaviors[1][t] = r->behavior;
+    }
+  }
+}
+
+static void TileDetect_OrField(uint8 op, uint16 bits) {
+  const TileDetectField *f = &kTileDetectFields[op & 31];
+  uint16 v = bits << ((op >> 5) * 4);
+  if (f->is_byte)
+    *(uint8 *)f->ptr |= v;
+  else
+    *(uint16 *)f->ptr |= v;
+}
+
+static void TileDetect_ExecuteSpecial(const TileBehavior *tb, uint8 tile, uint16 offs, uint16 bits) {
+  static const uint8 word_87DC55[] = { 4, 0, 6, 2 };
+  switch (tb->handler) {
+  case kTdh_Interact:
+    index_of_interacting_tile = tile;
+    break;
+  case kTdh_Slope:  // TileBehavior_Slope, TileBehavior_SlopeOuter
+    tiledetect_diag_state = word_87DC55[tile & 3];
+    break;
+  case kTdh_SpikeFloor:  // TileBehavior_SpikeFloor
+    if (!flag_block_link_menu && !(dung_savegame_state_bits & 0x8000))
+      tiledetect_spike_floor_and_tile_triggers |= bits << 4;
+    break;
+  case kTdh_Pit:  // TileBehavior_Pit
+    if (!player_on_somaria_platform)
+      tiledetect_pit_tile |= bits;
+    break;
+  case kTdh_Spike:  // TileBehavior_Spike
+    if (!flag_block_link_menu && !(dung_savegame_state_bits & 0x8000))
+      bitfield_spike_cactus_tiles |= bits;
+    else
+      g_r14 |= bits;
+    break;
+  case kTdh_Liftable: {  // TileBehavior_Liftable
+    static const uint8 kTile50data[] = { 0x54, 0x52, 0x50, 0x51, 0x53, 0x55, 0x56 };
+    for (int i = 6; i >= 0; i--) {
+      if (kTile50data[i] == tile) {
+        if (tile == 0x50 || tile == 0x51)
+          bitmask_for_dashable_tiles |= bits << 4;
+        tiledetect_read_something |= bits;
+        interacting_with_liftable_tile_x2 = i * 2;
+        g_r14 |= bits;
+        tiledetect_misc_tiles |= bits;
+        break;
+      }
+    }
+    break;
+  }
+  case kTdh_Chest:  // TileBehavior_Chest
+    tiledetect_misc_tiles |= bits;
+    index_of_interacting_tile = tile;
+    if (dung_chest_locations[tile - 0x58] >= 0x8000) {
+      g_r14 |= bits;
+      tiledetect_key_lock_gravestones |= bits << 4;
+      if (bits & 2)
+        tiledetect_tile_type = tile;
+    } else {
+      tiledetect_chest |= bits;  // small key lock
+      g_r14 |= bits;
+    }
+    break;
+  case kTdh_RupeeTile:  // TileBehavior_RupeeTile
+    if (dung_bg2_attr_table[offs + 64] == 0x60) {
+      tiledetect_misc_tiles |= bits << 8;
+    } else {
+      tiledetect_misc_tiles |= bits << 12;
+    }
+    break;
+  case kTdh_ManipulablyReplaced:  // TileBehavior_ManipulablyReplaced
+    if (bits & 2)
+      tiledetect_var2 |= 1 << (tile & 0xf);
+    break;
+  case kTdh_LayerToggleShutterDoor:
+    room_transitioning_flags = 1;
+    tiledetect_var1 = 2 * (tile & 1);
+    break;
+  case kTdh_LayerAndDungeonToggleShutterDoor:
+    room_transitioning_flags = 3;
+    tiledetect_var1 = 2 * (tile & 1);
+    break;
+  case kTdh_DungeonToggleDoor:
+    room_transitioning_flags = 2;
+    tiledetect_var1 = 2 * (tile & 1);
+    break;
+  case kTdh_Door:
+    tiledetect_var1 = 2 * (tile & 1);
+    break;
+  case kTdh_Entrance:  // TileBehavior_Entrance
+    tiledetect_var1 = 0;
+    break;
+  }
+}
+
 void TileDetect_ExecuteInner(uint8 tile, uint16 offs, uint16 bits, bool is_indoors) {  // 87dc2e
+  if (cheatWalkThroughWalls)
+    tile = 0;
+
+  const TileBehavior *tb = &g_tile_behaviors[is_indoors][tile];
+  if (tb->ops[0]) {
+    TileDetect_OrField(tb->ops[0], bits);
+    if (tb->ops[1]) {
+      TileDetect_OrField(tb->ops[1], bits);
+      if (tb->ops[2])
+        TileDetect_OrField(tb->ops[2], bits);
+    }
+  }
+  if (tb->handler)
+    TileDetect_ExecuteSpecial(tb, tile, offs, bits);
+}
+
+#ifndef NDEBUG
+// The switch TileDetect_ExecuteInner used before kTileBehaviorRules, kept as
+// the reference for TileDetect_SelfTest.
+static void TileDetect_ExecuteInnerReference(uint8 tile, uint16 offs, uint16 bits, bool is_indoors) {
   static const uint8 word_87DC55[] = { 4, 0, 6, 2 };
   if (cheatWalkThroughWalls)
     tile = 0;
@@ -525,3 +866,46 @@ void TileDetect_ExecuteInner(uint8 tile, uint16 offs, uint16 bits, bool is_indoo
   }
 }
 
+// Runs the table and the reference switch for every tile, both modes, every
+// probe bit combination and each state the special handlers read, and
+// compares all of RAM afterwards. RAM is restored when done.
+bool TileDetect_SelfTest() {
+  enum { kRamSize = 0x20000 };
+  uint8 *saved = malloc(kRamSize * 3), *before = saved + kRamSize, *expected = before + kRamSize;
+  memcpy(saved, g_ram, kRamSize);
+  bool ok = true;
+  for (int tile = 0; tile < 256 && ok; tile++) {
+    for (int cond = 0; cond < 32 && ok; cond++) {
+      srand(tile * 977 + cond);
+      for (int i = 0; i < 0x2000; i++)
+        g_ram[i] = rand();
+      cheatWalkThroughWalls = 0;
+      flag_block_link_menu = cond & 1;
+      dung_savegame_state_bits = (cond & 2) ? 0x8000 : 0;
+      player_on_somaria_platform = (cond >> 2) & 1;
+      for (int i = 0; i < 6; i++)
+        dung_chest_locations[i] = (cond & 8) ? 0x8000 : 0x100;
+      uint16 offs = 0x100;
+      dung_bg2_attr_table[offs + 64] = (cond & 16) ? 0x60 : 0x61;
+      memcpy(before, g_ram, kRamSize);
+      for (int is_indoors = 0; is_indoors < 2 && ok; is_indoors++) {
+        for (int bits = 1; bits <= 15 && ok; bits++) {
+          memcpy(g_ram, before, kRamSize);
+          TileDetect_ExecuteInnerReference(tile, offs, bits, is_indoors);
+          memcpy(expected, g_ram, kRamSize);
+          memcpy(g_ram, before, kRamSize);
+          TileDetect_ExecuteInner(tile, offs, bits, is_indoors);
+          if (memcmp(expected, g_ram, kRamSize)) {
+            fprintf(stderr, "TileDetect: mismatch for tile %.2X, %s, bits %d, state %d\n",
+                    tile, is_indoors ? "indoors" : "outdoors", bits, cond);
+            ok = false;
+          }
+        }
+      }
+    }
+  }
+  memcpy(g_ram, saved, kRamSize);
+  free(saved);
+  return ok;
+}
+#endif  // NDEBUG
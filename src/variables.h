@@ -708,6 +708,9 @@
 #define number_of_times_hurt_by_sprites (*(uint8*)(g_ram+0xCFC))
 #define rupee_sfx_sound_delay (*(uint8*)(g_ram+0xCFD))
 #define word_7E0CFE (*(uint16*)(g_ram+0xCFE))
+// The per-slot sprite arrays from here to 0xF9F are already laid out as one
+// contiguous structure-of-arrays block (about 1KB), so they stay in the SNES
+// layout that verification and snapshots rely on.
 #define sprite_y_lo ((uint8*)(g_ram+0xD00))
 #define sprite_x_lo ((uint8*)(g_ram+0xD10))
 #define sprite_y_hi ((uint8*)(g_ram+0xD20))
@@ -102,15 +102,15 @@ typedef struct {
   VkBuffer index_buffer;
   VkDeviceMemory index_buffer_memory;
 
-  // Staging buffer for texture uploads
-  VkBuffer staging_buffer;
-  VkDeviceMemory staging_buffer_memory;
-  void *staging_buffer_mapped;
+  // One staging buffer per frame in flight; the PPU renders straight into
+  // the mapped memory of the current frame's buffer.
+  VkBuffer staging_buffers[MAX_FRAMES_IN_FLIGHT];
+  VkDeviceMemory staging_buffer_memories[MAX_FRAMES_IN_FLIGHT];
+  void *staging_buffer_mapped[MAX_FRAMES_IN_FLIGHT];
 
   // Game texture dimensions
   int texture_width;
   int texture_height;
-  uint8_t *pixel_buffer;
 } VulkanState;
 
 static VulkanState vk = {0};
@@ -297,6 +297,33 @@ static VkShaderModule LoadShaderFromAsset(const char *asset_path) {
 #endif
 }
 
+static VkPresentModeKHR ChoosePresentMode() {
+  VkPresentModeKHR wanted;
+  switch (g_config.present_mode) {
+  case kPresentMode_FifoRelaxed: wanted = VK_PRESENT_MODE_FIFO_RELAXED_KHR; break;
+  case kPresentMode_Mailbox: wanted = VK_PRESENT_MODE_MAILBOX_KHR; break;
+  case kPresentMode_Immediate: wanted = VK_PRESENT_MODE_IMMEDIATE_KHR; break;
+  default: return VK_PRESENT_MODE_FIFO_KHR;
+  }
+
+  uint32_t mode_count = 0;
+  vkGetPhysicalDeviceSurfacePresentModesKHR(vk.physical_device, vk.surface, &mode_count, NULL);
+  VkPresentModeKHR *modes = malloc(mode_count * sizeof(VkPresentModeKHR));
+  vkGetPhysicalDeviceSurfacePresentModesKHR(vk.physical_device, vk.surface, &mode_count, modes);
+
+  bool found = false;
+  for (uint32_t i = 0; i < mode_count; i++)
+    found |= (modes[i] == wanted);
+  free(modes);
+
+  if (!found) {
+    // FIFO is the only mode the spec guarantees
+    VK_LOG("Present mode %d not supported, falling back to FIFO", (int)wanted);
+    return VK_PRESENT_MODE_FIFO_KHR;
+  }
+  return wanted;
+}
+
 static bool CreateSwapchain() {
   VkSurfaceCapabilitiesKHR capabilities;
   vkGetPhysicalDeviceSurfaceCapabilitiesKHR(vk.physical_device, vk.surface, &capabilities);
@@ -342,7 +369,7 @@ static bool CreateSwapchain() {
   // Using currentTransform can cause incorrect rotation on some Android devices
   create_info.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
   create_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-  create_info.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+  create_info.presentMode = ChoosePresentMode();
   create_info.clipped = VK_TRUE;
   create_info.oldSwapchain = VK_NULL_HANDLE;
 
@@ -362,7 +389,8 @@ static bool CreateSwapchain() {
     vk.swapchain_image_views[i] = CreateImageView(vk.swapchain_images[i], vk.swapchain_format);
   }
 
-  VK_LOG("Swapchain created: %ux%u, %u images", vk.swapchain_extent.width, vk.swapchain_extent.height, vk.swapchain_image_count);
+  VK_LOG("Swapchain created: %ux%u, %u images, present mode %d", vk.swapchain_extent.width, vk.swapchain_extent.height,
+         vk.swapchain_image_count, (int)create_info.presentMode);
   return true;
 }
 
@@ -834,16 +862,19 @@ static bool CreateTextureResources(int width, int height) {
 
   vkUpdateDescriptorSets(vk.device, 1, &descriptor_write, 0, NULL);
 
-  // Create staging buffer for texture uploads (persistent)
+  // Create one staging buffer per frame in flight (persistent), so the CPU can
+  // render the next frame while the GPU is still copying the previous one
   VkDeviceSize buffer_size = width * height * 4;
-  if (!CreateBuffer(buffer_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                    &vk.staging_buffer, &vk.staging_buffer_memory)) {
-    return false;
-  }
+  for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    if (!CreateBuffer(buffer_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                      &vk.staging_buffers[i], &vk.staging_buffer_memories[i])) {
+      return false;
+    }
 
-  // Map staging buffer permanently
-  vkMapMemory(vk.device, vk.staging_buffer_memory, 0, buffer_size, 0, &vk.staging_buffer_mapped);
+    // Map staging buffer permanently
+    vkMapMemory(vk.device, vk.staging_buffer_memories[i], 0, buffer_size, 0, &vk.staging_buffer_mapped[i]);
+  }
 
   // Transition texture to shader read layout
   VkCommandBufferAllocateInfo cmd_alloc_info = {0};
@@ -895,6 +926,32 @@ static bool CreateTextureResources(int width, int height) {
   return true;
 }
 
+static void DestroyStagingBuffers() {
+  for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    if (vk.staging_buffer_mapped[i]) vkUnmapMemory(vk.device, vk.staging_buffer_memories[i]);
+    if (vk.staging_buffers[i]) vkDestroyBuffer(vk.device, vk.staging_buffers[i], NULL);
+    if (vk.staging_buffer_memories[i]) vkFreeMemory(vk.device, vk.staging_buffer_memories[i], NULL);
+    vk.staging_buffer_mapped[i] = NULL;
+    vk.staging_buffers[i] = VK_NULL_HANDLE;
+    vk.staging_buffer_memories[i] = VK_NULL_HANDLE;
+  }
+}
+
+static void DestroyTextureResources() {
+  if (vk.descriptor_pool) vkDestroyDescriptorPool(vk.device, vk.descriptor_pool, NULL);
+  if (vk.texture_sampler) vkDestroySampler(vk.device, vk.texture_sampler, NULL);
+  if (vk.texture_image_view) vkDestroyImageView(vk.device, vk.texture_image_view, NULL);
+  if (vk.texture_image) vkDestroyImage(vk.device, vk.texture_image, NULL);
+  if (vk.texture_memory) vkFreeMemory(vk.device, vk.texture_memory, NULL);
+  vk.descriptor_pool = VK_NULL_HANDLE;
+  vk.descriptor_set = VK_NULL_HANDLE;
+  vk.texture_sampler = VK_NULL_HANDLE;
+  vk.texture_image_view = VK_NULL_HANDLE;
+  vk.texture_image = VK_NULL_HANDLE;
+  vk.texture_memory = VK_NULL_HANDLE;
+  DestroyStagingBuffers();
+}
+
 static bool VulkanRenderer_Init(SDL_Window *window) {
   VK_LOG("Initializing Vulkan renderer");
 
@@ -1113,17 +1170,7 @@ static void VulkanRenderer_Destroy() {
   free(vk.render_finished_semaphores);
   free(vk.in_flight_fences);
 
-  if (vk.staging_buffer_mapped) {
-    vkUnmapMemory(vk.device, vk.staging_buffer_memory);
-  }
-  if (vk.staging_buffer) vkDestroyBuffer(vk.device, vk.staging_buffer, NULL);
-  if (vk.staging_buffer_memory) vkFreeMemory(vk.device, vk.staging_buffer_memory, NULL);
-
-  if (vk.descriptor_pool) vkDestroyDescriptorPool(vk.device, vk.descriptor_pool, NULL);
-  if (vk.texture_sampler) vkDestroySampler(vk.device, vk.texture_sampler, NULL);
-  if (vk.texture_image_view) vkDestroyImageView(vk.device, vk.texture_image_view, NULL);
-  if (vk.texture_image) vkDestroyImage(vk.device, vk.texture_image, NULL);
-  if (vk.texture_memory) vkFreeMemory(vk.device, vk.texture_memory, NULL);
+  DestroyTextureResources();
 
   if (vk.vertex_buffer) vkDestroyBuffer(vk.device, vk.vertex_buffer, NULL);
   if (vk.vertex_buffer_memory) vkFreeMemory(vk.device, vk.vertex_buffer_memory, NULL);
@@ -1158,8 +1205,6 @@ static void VulkanRenderer_Destroy() {
   if (vk.surface) vkDestroySurfaceKHR(vk.instance, vk.surface, NULL);
   if (vk.instance) vkDestroyInstance(vk.instance, NULL);
 
-  free(vk.pixel_buffer);
-
   memset(&vk, 0, sizeof(vk));
 
   VK_LOG("Vulkan renderer destroyed");
@@ -1172,40 +1217,39 @@ static void VulkanRenderer_BeginDraw(int width, int height, uint8_t **pixels, in
   }
   frame_count++;
 
-  if (!vk.pixel_buffer || vk.texture_width != width || vk.texture_height != height) {
+  if (!vk.texture_image || vk.texture_width != width || vk.texture_height != height) {
     // Recreate texture if dimensions changed
     if (vk.texture_image) {
       vkDeviceWaitIdle(vk.device);
-
-      vkDestroyDescriptorPool(vk.device, vk.descriptor_pool, NULL);
-      vkDestroySampler(vk.device, vk.texture_sampler, NULL);
-      vkDestroyImageView(vk.device, vk.texture_image_view, NULL);
-      vkDestroyImage(vk.device, vk.texture_image, NULL);
-      vkFreeMemory(vk.device, vk.texture_memory, NULL);
-
-      if (vk.staging_buffer_mapped) {
-        vkUnmapMemory(vk.device, vk.staging_buffer_memory);
-      }
-      vkDestroyBuffer(vk.device, vk.staging_buffer, NULL);
-      vkFreeMemory(vk.device, vk.staging_buffer_memory, NULL);
+      DestroyTextureResources();
     }
 
-    free(vk.pixel_buffer);
     vk.texture_width = width;
     vk.texture_height = height;
-    vk.pixel_buffer = malloc(width * height * 4);
 
-    CreateTextureResources(width, height);
+    if (!CreateTextureResources(width, height)) {
+      // Free whatever was created so the next frame starts over
+      VK_ERR("Failed to create %dx%d texture resources, skipping frame", width, height);
+      vkDeviceWaitIdle(vk.device);
+      DestroyTextureResources();
+      *pixels = NULL;
+      *pitch = 0;
+      return;
+    }
   }
 
-  *pixels = vk.pixel_buffer;
+  // Only block until the GPU is done with this frame's staging buffer, which
+  // was submitted MAX_FRAMES_IN_FLIGHT frames ago
+  vkWaitForFences(vk.device, 1, &vk.in_flight_fences[vk.current_frame], VK_TRUE, UINT64_MAX);
+
+  *pixels = vk.staging_buffer_mapped[vk.current_frame];
   *pitch = width * 4;
 }
 
 static void VulkanRenderer_EndDraw() {
-  // Wait for previous frame
-  vkWaitForFences(vk.device, 1, &vk.in_flight_fences[vk.current_frame], VK_TRUE, UINT64_MAX);
-
+  if (!vk.texture_image)
+    return;  // BeginDraw failed to create the texture
+  // The in-flight fence for this frame was already waited on in BeginDraw
   // Acquire next swapchain image
   uint32_t image_index;
   VkResult result = vkAcquireNextImageKHR(vk.device, vk.swapchain, UINT64_MAX,
@@ -1220,9 +1264,6 @@ static void VulkanRenderer_EndDraw() {
 
   vkResetFences(vk.device, 1, &vk.in_flight_fences[vk.current_frame]);
 
-  // Upload texture data
-  memcpy(vk.staging_buffer_mapped, vk.pixel_buffer, vk.texture_width * vk.texture_height * 4);
-
   VkCommandBuffer cmd = vk.command_buffers[vk.current_frame];
   vkResetCommandBuffer(cmd, 0);
 
@@ -1266,7 +1307,7 @@ static void VulkanRenderer_EndDraw() {
   region.imageExtent.height = vk.texture_height;
   region.imageExtent.depth = 1;
 
-  vkCmdCopyBufferToImage(cmd, vk.staging_buffer, vk.texture_image,
+  vkCmdCopyBufferToImage(cmd, vk.staging_buffers[vk.current_frame], vk.texture_image,
                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
 
   // Transition texture back to shader read
@@ -4,6 +4,7 @@
 #include "zelda_cpu_infra.h"
 #include "zelda_rtl.h"
 #include "variables.h"
+#include "sprite.h"
 #include "spc_player.h"
 #include "snes/snes.h"
 #include "snes/snes_regs.h"
@@ -58,6 +59,7 @@ static void MakeMySnapshot(Snapshot *s) {
 
 static void RestoreMySnapshot(Snapshot *s) {
   memcpy(g_zenv.ram, s->ram, 0x20000);
+  Sprite_InvalidateOverworldIndex();
   memcpy(g_zenv.sram, s->sram, 0x2000);
   memcpy(g_zenv.ppu->vram, s->vram, sizeof(uint16) * 0x8000);
 }
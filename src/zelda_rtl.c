@@ -1,8 +1,11 @@
 #include "zelda_rtl.h"
 #include "variables.h"
+#include "sprite.h"
 #include "misc.h"
 #include "nmi.h"
 #include "poly.h"
+#include "tile_detect.h"
+#include "load_gfx.h"
 #include "attract.h"
 #include "snes/ppu.h"
 #include "snes/snes_regs.h"
@@ -278,8 +281,21 @@ void ZeldaInitialize() {
   SpcPlayer_Initialize(g_zenv.player);
   dma_reset(g_zenv.dma);
   ppu_reset(g_zenv.ppu);
+  TileDetect_InitBehaviorTable();
 }
 
+#ifndef NDEBUG
+// Exhaustive checks of table-driven rewrites against the code they replaced.
+// Too slow for every startup, so they only run with --selftest.
+bool ZeldaRunSelfTests() {
+  bool ok = PaletteFilter_SelfTest();
+  TileDetect_InitBehaviorTable();
+  ok &= TileDetect_SelfTest();
+  fprintf(stderr, "Self tests %s\n", ok ? "passed" : "FAILED");
+  return ok;
+}
+#endif  // NDEBUG
+
 static void ZeldaRunPolyLoop() {
   if (intro_did_run_step && !nmi_flag_update_polyhedral) {
     Poly_RunFrame();
@@ -389,6 +405,7 @@ void ZeldaReset(bool preserve_sram) {
   memset(g_zenv.ram, 0, 0x20000);
   if (!preserve_sram)
     memset(g_zenv.sram, 0, 0x2000);
+  Sprite_InvalidateOverworldIndex();
   ZeldaApuLock();
   ZeldaRestoreMusicAfterLoad_Locked(true);
   ZeldaApuUnlock();
@@ -401,6 +418,7 @@ static void LoadSnesState(SaveLoadFunc *func, void *ctx) {
   ZeldaApuLock();
   InternalSaveLoad(func, ctx);
   memcpy(g_zenv.ram + 0x1DBA0, g_zenv.ram + 0x1b00, 224 * 2); // hdma table was moved
+  Sprite_InvalidateOverworldIndex();
 
   ZeldaRestoreMusicAfterLoad_Locked(false);
   ZeldaApuUnlock();
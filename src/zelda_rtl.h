@@ -45,6 +45,9 @@ void zelda_ppu_write_word(uint32_t adr, uint16_t val);
 void HdmaSetup(uint32 addr6, uint32 addr7, uint8 transfer_unit, uint8 reg6, uint8 reg7, uint8 indirect_bank);
 
 void ZeldaInitialize();
+#ifndef NDEBUG
+bool ZeldaRunSelfTests();
+#endif  // NDEBUG
 void ZeldaReset(bool preserve_sram);
 void ZeldaDrawPpuFrame(uint8 *pixel_buffer, size_t pitch, uint32 render_flags);
 void ZeldaRunFrameInternal(uint16 input, int run_what);